@@ -0,0 +1,98 @@
+#include "broadphase.h"
+
+static int clamp_int(int value, int min, int max) {
+    if (value < min) return min;
+    if (value > max) return max;
+    return value;
+}
+
+// Items outside of the playfield are binned into the border cells, queries
+// get clamped the same way so nothing is missed.
+static int col_of(int x) {
+    return clamp_int(x >> BROADPHASE_CELL_SHIFT, 0, BROADPHASE_COLS - 1);
+}
+
+static int row_of(int y) {
+    return clamp_int(y >> BROADPHASE_CELL_SHIFT, 0, BROADPHASE_ROWS - 1);
+}
+
+void broadphase_init(Broadphase* grid, int item_width, int item_height) {
+    grid->item_width = item_width;
+    grid->item_height = item_height;
+    for (int i = 0; i < BROADPHASE_CELLS; i++) {
+        grid->head[i] = BROADPHASE_NONE;
+    }
+}
+
+void broadphase_insert(Broadphase* grid, int index, int x, int y) {
+    int cell = row_of(y) * BROADPHASE_COLS + col_of(x);
+    grid->next[index] = grid->head[cell];
+    grid->head[cell] = index;
+}
+
+void broadphase_build(
+    Broadphase* grid,
+    int item_width,
+    int item_height,
+    const Fou_Coord* x,
+    const Fou_Coord* y,
+    int len)
+{
+    broadphase_init(grid, item_width, item_height);
+    for (int i = 0; i < len; i++) {
+        broadphase_insert(grid, i, fou_coord_to_int(x[i]), fou_coord_to_int(y[i]));
+    }
+}
+
+void broadphase_query_begin(
+    Broadphase_Query* query,
+    const Broadphase* grid,
+    int x,
+    int y,
+    int width,
+    int height)
+{
+    // An item overlaps the rectangle only if its top left corner lies within
+    // the rectangle grown by the item size towards the top left.
+    query->grid = grid;
+    query->col_min = col_of(x - grid->item_width + 1);
+    query->col_max = col_of(x + width - 1);
+    query->row_max = row_of(y + height - 1);
+    query->col = query->col_min;
+    query->row = row_of(y - grid->item_height + 1);
+    query->item = grid->head[query->row * BROADPHASE_COLS + query->col];
+}
+
+int broadphase_query_next(Broadphase_Query* query) {
+    while (query->item == BROADPHASE_NONE) {
+        if (query->col < query->col_max) {
+            query->col++;
+        } else if (query->row < query->row_max) {
+            query->row++;
+            query->col = query->col_min;
+        } else {
+            return BROADPHASE_NONE;
+        }
+        query->item = query->grid->head[query->row * BROADPHASE_COLS + query->col];
+    }
+    int item = query->item;
+    query->item = query->grid->next[item];
+    return item;
+}
+
+int broadphase_mark_pews(const Broadphase* grid, Pews* pews, int x, int y, int width, int height) {
+    int count = 0;
+    Broadphase_Query query;
+    broadphase_query_begin(&query, grid, x, y, width, height);
+    int i;
+    while ((i = broadphase_query_next(&query)) != BROADPHASE_NONE) {
+        int px = fou_coord_to_int(pews->x[i]);
+        int py = fou_coord_to_int(pews->y[i]);
+        if (px + grid->item_width > x && px < x + width && py + grid->item_height > y &&
+            py < y + height) {
+            pew_mark(pews, i);
+            count++;
+        }
+    }
+    return count;
+}
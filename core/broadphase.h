@@ -0,0 +1,78 @@
+/*
+ * Uniform grid over the 128x64 playfield used to find collision candidates.
+ *
+ * Every item is binned by the cell that contains its top left corner, cells
+ * are singly linked lists threaded through `next`. A grid is meant to be
+ * filled after the items moved each tick and thrown away afterwards, so there
+ * is no removal.
+ *
+ * It pays off where many rectangles are tested against one pool, the enemies
+ * against the player's pews. Builds without PEW_OVERLAP_SCAN use it for that.
+ */
+
+#ifndef BROADPHASE_H
+#define BROADPHASE_H
+
+#include <stdint.h>
+
+#include "pew.h"
+
+#define BROADPHASE_CELL_SHIFT 4 // 16x16 pixel cells
+#define BROADPHASE_COLS (128 >> BROADPHASE_CELL_SHIFT)
+#define BROADPHASE_ROWS (64 >> BROADPHASE_CELL_SHIFT)
+#define BROADPHASE_CELLS (BROADPHASE_COLS * BROADPHASE_ROWS)
+#define BROADPHASE_MAX_ITEMS (PEW_CAP > ENEMY_PEW_CAP ? PEW_CAP : ENEMY_PEW_CAP)
+#define BROADPHASE_NONE -1
+
+typedef struct {
+    // all items of one grid have the same hitbox size
+    int item_width;
+    int item_height;
+    int16_t head[BROADPHASE_CELLS];
+    int16_t next[BROADPHASE_MAX_ITEMS];
+} Broadphase;
+
+/// Iterator over the items that may overlap a queried rectangle.
+typedef struct {
+    const Broadphase* grid;
+    int col_min;
+    int col_max;
+    int row_max;
+    int col;
+    int row;
+    int item;
+} Broadphase_Query;
+
+void broadphase_init(Broadphase* grid, int item_width, int item_height);
+
+/// Bin item `index` whose hitbox has its top left corner at (x, y).
+void broadphase_insert(Broadphase* grid, int index, int x, int y);
+
+/// broadphase_init, then bin items [0, len) at the whole pixel positions of
+/// `x` and `y`.
+void broadphase_build(
+    Broadphase* grid,
+    int item_width,
+    int item_height,
+    const Fou_Coord* x,
+    const Fou_Coord* y,
+    int len);
+
+/// Start iterating over all items whose hitbox may overlap the given
+/// rectangle. Candidates still need an exact overlap test.
+void broadphase_query_begin(
+    Broadphase_Query* query,
+    const Broadphase* grid,
+    int x,
+    int y,
+    int width,
+    int height);
+
+/// Returns the next candidate index or BROADPHASE_NONE when done.
+int broadphase_query_next(Broadphase_Query* query);
+
+/// pew_mark_overlapping of the pews binned into `grid`, looking only at the
+/// ones in the cells the rectangle touches.
+int broadphase_mark_pews(const Broadphase* grid, Pews* pews, int x, int y, int width, int height);
+
+#endif
@@ -0,0 +1,126 @@
+#include <string.h>
+
+#include "dirty.h"
+
+#define FNV_PRIME 16777619u
+#define FNV_OFFSET 2166136261u
+
+static uint32_t hash_int(uint32_t hash, int value) {
+    return (hash ^ (uint32_t)value) * FNV_PRIME;
+}
+
+/// Hash of everything that decides the pixels of a draw call. Only looks at
+/// the fields of its kind, the rest of the union may be garbage.
+static uint32_t hash_call(const Draw_Call* dc, bool color, bool alpha) {
+    uint32_t hash = hash_int(FNV_OFFSET, dc->kind);
+    hash = hash_int(hash, color | (alpha << 1));
+    switch (dc->kind) {
+        case DRAW_CALL_FOU_DRAW_BOX:
+            hash = hash_int(hash, dc->fou_draw_box.x);
+            hash = hash_int(hash, dc->fou_draw_box.y);
+            hash = hash_int(hash, dc->fou_draw_box.width);
+            hash = hash_int(hash, dc->fou_draw_box.height);
+            break;
+        case DRAW_CALL_FOU_DRAW_DISC:
+            hash = hash_int(hash, dc->fou_draw_disc.x);
+            hash = hash_int(hash, dc->fou_draw_disc.y);
+            hash = hash_int(hash, dc->fou_draw_disc.radius);
+            break;
+        case DRAW_CALL_FOU_DRAW_DOT:
+            hash = hash_int(hash, dc->fou_draw_dot.x);
+            hash = hash_int(hash, dc->fou_draw_dot.y);
+            break;
+        case DRAW_CALL_FOU_DRAW_FRAME:
+            hash = hash_int(hash, dc->fou_draw_frame.x);
+            hash = hash_int(hash, dc->fou_draw_frame.y);
+            hash = hash_int(hash, dc->fou_draw_frame.width);
+            hash = hash_int(hash, dc->fou_draw_frame.height);
+            break;
+        case DRAW_CALL_FOU_DRAW_ICON:
+        case DRAW_CALL_FOU_DRAW_OUTLINED_ICON:
+            hash = hash_int(hash, dc->fou_draw_icon.x);
+            hash = hash_int(hash, dc->fou_draw_icon.y);
+            hash = hash_int(hash, dc->fou_draw_icon.icon);
+            break;
+        case DRAW_CALL_FOU_DRAW_STR:
+        case DRAW_CALL_FOU_DRAW_OUTLINED_STR: {
+            hash = hash_int(hash, dc->fou_draw_str.x);
+            hash = hash_int(hash, dc->fou_draw_str.y);
+            const char* c = dc->fou_draw_str.string;
+            for (; *c != '\0'; c++) {
+                hash = hash_int(hash, *c);
+            }
+        } break;
+        case DRAW_CALL_FOU_INVERT_COLOR:
+        case DRAW_CALL_FOU_SET_BITMAP_MODE:
+        case DRAW_CALL_FOU_SET_COLOR:
+            break;
+    }
+    return hash;
+}
+
+void dirty_tracker_reset(Dirty_Tracker* tracker) {
+    tracker->has_previous = false;
+    tracker->untracked_left = 0;
+}
+
+uint32_t dirty_tracker_update(Dirty_Tracker* tracker, const Draw_List* draw_list) {
+    if (tracker->untracked_left != 0) {
+        // the hashes are of a frame long gone, the next tracked frame starts over
+        tracker->untracked_left--;
+        tracker->has_previous = false;
+        return RASTER_ALL_TILES;
+    }
+
+    uint32_t hashes[RASTER_TILE_COUNT];
+    for (int t = 0; t < RASTER_TILE_COUNT; t++) {
+        hashes[t] = FNV_OFFSET;
+    }
+
+    // same starting state as a freshly reset canvas
+    bool color = true;
+    bool alpha = false;
+    for (size_t i = 0; i < draw_list->calls.size; i++) {
+        const Draw_Call* dc = &draw_list->calls.items[i];
+        tracker->call_tiles[i] = 0;
+        switch (dc->kind) {
+            case DRAW_CALL_FOU_INVERT_COLOR:
+                color = !color;
+                continue;
+            case DRAW_CALL_FOU_SET_COLOR:
+                color = dc->fou_set_color.color;
+                continue;
+            case DRAW_CALL_FOU_SET_BITMAP_MODE:
+                alpha = dc->fou_set_bitmap_mode.alpha;
+                continue;
+            default:
+                break;
+        }
+        Rect bounds;
+        draw_call_bounds(dc, &bounds);
+        uint32_t tiles = raster_tiles_covering(bounds);
+        tracker->call_tiles[i] = tiles;
+        if (tiles == 0) {
+            continue;
+        }
+        uint32_t hash = hash_call(dc, color, alpha);
+        for (; tiles != 0; tiles &= tiles - 1) {
+            int t = __builtin_ctz(tiles);
+            hashes[t] = (hashes[t] ^ hash) * FNV_PRIME;
+        }
+    }
+
+    uint32_t dirty = 0;
+    for (int t = 0; t < RASTER_TILE_COUNT; t++) {
+        if (!tracker->has_previous || hashes[t] != tracker->tile_hashes[t]) {
+            dirty |= 1u << t;
+        }
+    }
+    // a first frame is all dirty without saying anything about the next ones
+    if (tracker->has_previous && __builtin_popcount(dirty) > DIRTY_MAX_TILES) {
+        tracker->untracked_left = DIRTY_UNTRACKED_FRAMES;
+    }
+    memcpy(tracker->tile_hashes, hashes, sizeof(hashes));
+    tracker->has_previous = true;
+    return dirty;
+}
@@ -0,0 +1,46 @@
+/*
+ * Which parts of the screen changed between two recorded frames.
+ *
+ * Every tile of the screen (see raster.h) gets a hash of the draws that touch
+ * it, in order and together with the color and bitmap mode they are drawn
+ * with. Comparing those against the hashes of the previous frame's list gives
+ * the tiles whose pixels may differ, without keeping the previous list around.
+ *
+ * Hashing costs about a quarter of drawing the list, redrawing only the dirty
+ * tiles saves less than that once many of them changed. After a frame like
+ * that the tracker stops looking for a few frames and has them redrawn whole.
+ */
+
+#ifndef DIRTY_H
+#define DIRTY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "draw_list.h"
+#include "raster.h"
+
+/// More dirty tiles than this and tracking them costs more than it saves.
+#define DIRTY_MAX_TILES (RASTER_TILE_COUNT / 4)
+/// Frames redrawn whole without tracking after one over DIRTY_MAX_TILES.
+#define DIRTY_UNTRACKED_FRAMES 8
+
+typedef struct {
+    uint32_t tile_hashes[RASTER_TILE_COUNT];
+    bool has_previous; // false until the first frame went through
+    int untracked_left; // frames still redrawn whole without being tracked
+    // Tiles every call of the last list touches, 0 for state changes. Lets
+    // raster_draw_list_tiles skip draws without working out their bounds again.
+    uint32_t call_tiles[MAX_DRAW_CALLS];
+} Dirty_Tracker;
+
+/// Forget the previous frame, everything is dirty next time.
+void dirty_tracker_reset(Dirty_Tracker* tracker);
+
+/// Tile mask of everything that changed since the last list passed in, 0 if
+/// `draw_list` draws exactly the same as that one. While the tracker backs off
+/// after a busy frame it is RASTER_ALL_TILES, without looking at the list or
+/// filling in `call_tiles`.
+uint32_t dirty_tracker_update(Dirty_Tracker* tracker, const Draw_List* draw_list);
+
+#endif
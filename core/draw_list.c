@@ -0,0 +1,288 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "draw_list.h"
+#include "sprite.h"
+#include <core/check.h>
+
+void draw_list_init(Draw_List* draw_list) {
+    *draw_list = (Draw_List){0};
+    // malloc'd memory is aligned for any type, so calls can start right at
+    // the beginning
+    draw_list->arena = malloc(DRAW_LIST_ARENA_SIZE);
+    furi_check(draw_list->arena != NULL, "failed to allocate draw list arena");
+    draw_list->calls.items = (Draw_Call*)draw_list->arena;
+    draw_list_clear(draw_list);
+}
+
+void draw_list_free(Draw_List* draw_list) {
+    free(draw_list->arena);
+    *draw_list = (Draw_List){0};
+}
+
+void draw_list_clear(Draw_List* draw_list) {
+    draw_list->calls.size = 0;
+    draw_list->strings_start = DRAW_LIST_ARENA_SIZE;
+    draw_list->priority = FOU_DRAW_PRIORITY_NORMAL;
+}
+
+// generous upper bounds for the secondary font
+#define GLYPH_WIDTH 8
+#define GLYPH_ASCENT 10
+#define GLYPH_DESCENT 3
+
+bool draw_call_bounds(const Draw_Call* dc, Rect* bounds) {
+    switch (dc->kind) {
+        case DRAW_CALL_FOU_DRAW_BOX:
+            *bounds = (Rect){
+                dc->fou_draw_box.x,
+                dc->fou_draw_box.y,
+                dc->fou_draw_box.width,
+                dc->fou_draw_box.height};
+            return true;
+        case DRAW_CALL_FOU_DRAW_DISC: {
+            int r = dc->fou_draw_disc.radius;
+            *bounds = (Rect){dc->fou_draw_disc.x - r, dc->fou_draw_disc.y - r, 2 * r + 1, 2 * r + 1};
+            return true;
+        }
+        case DRAW_CALL_FOU_DRAW_DOT:
+            *bounds = (Rect){dc->fou_draw_dot.x, dc->fou_draw_dot.y, 1, 1};
+            return true;
+        case DRAW_CALL_FOU_DRAW_FRAME:
+            *bounds = (Rect){
+                dc->fou_draw_frame.x,
+                dc->fou_draw_frame.y,
+                dc->fou_draw_frame.width,
+                dc->fou_draw_frame.height};
+            return true;
+        case DRAW_CALL_FOU_DRAW_ICON:
+        case DRAW_CALL_FOU_DRAW_OUTLINED_ICON: {
+            const Fou_Sprite* sprite = fou_sprite(dc->fou_draw_icon.icon);
+            *bounds = (Rect){dc->fou_draw_icon.x, dc->fou_draw_icon.y, sprite->width, sprite->height};
+            if (dc->kind == DRAW_CALL_FOU_DRAW_OUTLINED_ICON) {
+                *bounds = (Rect){bounds->x - 1, bounds->y - 1, bounds->w + 2, bounds->h + 2};
+            }
+            return true;
+        }
+        case DRAW_CALL_FOU_DRAW_STR:
+        case DRAW_CALL_FOU_DRAW_OUTLINED_STR: {
+            int len = strlen(dc->fou_draw_str.string);
+            *bounds = (Rect){
+                dc->fou_draw_str.x,
+                dc->fou_draw_str.y - GLYPH_ASCENT,
+                len * GLYPH_WIDTH,
+                GLYPH_ASCENT + GLYPH_DESCENT};
+            if (dc->kind == DRAW_CALL_FOU_DRAW_OUTLINED_STR) {
+                *bounds = (Rect){bounds->x - 1, bounds->y - 1, bounds->w + 2, bounds->h + 2};
+            }
+            return true;
+        }
+        case DRAW_CALL_FOU_INVERT_COLOR:
+        case DRAW_CALL_FOU_SET_BITMAP_MODE:
+        case DRAW_CALL_FOU_SET_COLOR:
+            break;
+    }
+    return false;
+}
+
+static bool is_state_call(Draw_Call_Kind kind) {
+    return kind == DRAW_CALL_FOU_INVERT_COLOR || kind == DRAW_CALL_FOU_SET_BITMAP_MODE ||
+           kind == DRAW_CALL_FOU_SET_COLOR;
+}
+
+/// Whether `call_bytes` more bytes of calls and `string_bytes` more bytes of
+/// strings fit, given the priority of what is pushed.
+static bool has_room(const Draw_List* draw_list, bool low, size_t call_bytes, size_t string_bytes) {
+    size_t used = sizeof(Draw_Call) * draw_list->calls.size +
+                  (DRAW_LIST_ARENA_SIZE - draw_list->strings_start);
+    size_t limit = DRAW_LIST_ARENA_SIZE - (low ? DRAW_LIST_NORMAL_RESERVE : 0);
+    return used + call_bytes + string_bytes <= limit;
+}
+
+static void note_dropped(Draw_List* draw_list, bool low) {
+    if (low) {
+        draw_list->stats.dropped_low++;
+    } else {
+        draw_list->stats.dropped_normal++;
+    }
+}
+
+static void note_usage(Draw_List* draw_list) {
+    Draw_List_Stats* stats = &draw_list->stats;
+    size_t string_bytes = DRAW_LIST_ARENA_SIZE - draw_list->strings_start;
+    size_t bytes = sizeof(Draw_Call) * draw_list->calls.size + string_bytes;
+    if (bytes > stats->peak_bytes) stats->peak_bytes = bytes;
+    if (draw_list->calls.size > stats->peak_calls) stats->peak_calls = draw_list->calls.size;
+    if (string_bytes > stats->peak_string_bytes) stats->peak_string_bytes = string_bytes;
+}
+
+bool draw_list_push_call(Draw_List* draw_list, Draw_Call draw_call) {
+    size_t size = draw_list->calls.size;
+    if (draw_call.kind == DRAW_CALL_FOU_INVERT_COLOR && size > 0 &&
+        draw_list->calls.items[size - 1].kind == DRAW_CALL_FOU_INVERT_COLOR) {
+        // The two cancel out. Mostly happens when everything in between was
+        // dropped, so dropped draws do not keep eating up room.
+        draw_list->calls.size--;
+        return true;
+    }
+    // State changes only have to fit at all, dropping them would mess up
+    // every draw that follows.
+    bool low = draw_list->priority == FOU_DRAW_PRIORITY_LOW && !is_state_call(draw_call.kind);
+    if (!has_room(draw_list, low, sizeof(Draw_Call), 0)) {
+        note_dropped(draw_list, low);
+        return false;
+    }
+    draw_list->calls.items[draw_list->calls.size++] = draw_call;
+    note_usage(draw_list);
+    return true;
+}
+
+bool draw_list_push_str(
+    Draw_List* draw_list,
+    int x,
+    int y,
+    const char* string,
+    Fou_Str_Flags flags)
+{
+    size_t len = (flags & FOU_STR_STATIC) ? 0 : strlen(string) + 1;
+    bool low = draw_list->priority == FOU_DRAW_PRIORITY_LOW;
+    if (!has_room(draw_list, low, sizeof(Draw_Call), len)) {
+        note_dropped(draw_list, low);
+        return false;
+    }
+    if (len != 0) {
+        draw_list->strings_start -= len;
+        string = memcpy(draw_list->arena + draw_list->strings_start, string, len);
+    }
+    Draw_Call_Kind kind = (flags & FOU_STR_OUTLINED) ? DRAW_CALL_FOU_DRAW_OUTLINED_STR :
+                                                        DRAW_CALL_FOU_DRAW_STR;
+    draw_list->calls.items[draw_list->calls.size++] = (Draw_Call){
+        .kind = kind, .fou_draw_str = {.x = x, .y = y, .string = string}};
+    note_usage(draw_list);
+    return true;
+}
+
+static void target_draw_box(void* context, int x, int y, int width, int height) {
+    draw_list_push_call(
+        context,
+        (Draw_Call){
+            .kind = DRAW_CALL_FOU_DRAW_BOX,
+            .fou_draw_box = {.x = x, .y = y, .width = width, .height = height}});
+}
+
+static void target_draw_disc(void* context, int x, int y, int radius) {
+    draw_list_push_call(
+        context,
+        (Draw_Call){
+            .kind = DRAW_CALL_FOU_DRAW_DISC, .fou_draw_disc = {.x = x, .y = y, .radius = radius}});
+}
+
+static void target_draw_dot(void* context, int x, int y) {
+    draw_list_push_call(
+        context, (Draw_Call){.kind = DRAW_CALL_FOU_DRAW_DOT, .fou_draw_dot = {.x = x, .y = y}});
+}
+
+static void target_draw_frame(void* context, int x, int y, int width, int height) {
+    draw_list_push_call(
+        context,
+        (Draw_Call){
+            .kind = DRAW_CALL_FOU_DRAW_FRAME,
+            .fou_draw_frame = {.x = x, .y = y, .width = width, .height = height}});
+}
+
+static void target_draw_icon(void* context, int x, int y, Fou_Icon icon) {
+    draw_list_push_call(
+        context,
+        (Draw_Call){
+            .kind = DRAW_CALL_FOU_DRAW_ICON, .fou_draw_icon = {.x = x, .y = y, .icon = icon}});
+}
+
+static void target_draw_outlined_icon(void* context, int x, int y, Fou_Icon icon) {
+    draw_list_push_call(
+        context,
+        (Draw_Call){
+            .kind = DRAW_CALL_FOU_DRAW_OUTLINED_ICON,
+            .fou_draw_icon = {.x = x, .y = y, .icon = icon}});
+}
+
+static void target_draw_str(void* context, int x, int y, const char* string, Fou_Str_Flags flags) {
+    draw_list_push_str(context, x, y, string, flags);
+}
+
+static void target_invert_color(void* context) {
+    draw_list_push_call(context, (Draw_Call){.kind = DRAW_CALL_FOU_INVERT_COLOR});
+}
+
+static void target_set_bitmap_mode(void* context, bool alpha) {
+    draw_list_push_call(
+        context,
+        (Draw_Call){.kind = DRAW_CALL_FOU_SET_BITMAP_MODE, .fou_set_bitmap_mode.alpha = alpha});
+}
+
+static void target_set_color(void* context, bool color) {
+    draw_list_push_call(
+        context, (Draw_Call){.kind = DRAW_CALL_FOU_SET_COLOR, .fou_set_color.color = color});
+}
+
+static void target_set_draw_priority(void* context, Fou_Draw_Priority priority) {
+    Draw_List* draw_list = context;
+    draw_list->priority = priority;
+}
+
+static const Fou_Render_Functions render_functions = {
+    .draw_box = target_draw_box,
+    .draw_disc = target_draw_disc,
+    .draw_dot = target_draw_dot,
+    .draw_frame = target_draw_frame,
+    .draw_icon = target_draw_icon,
+    .draw_outlined_icon = target_draw_outlined_icon,
+    .draw_str = target_draw_str,
+    .invert_color = target_invert_color,
+    .set_bitmap_mode = target_set_bitmap_mode,
+    .set_color = target_set_color,
+    .set_draw_priority = target_set_draw_priority,
+};
+
+Fou_Render_Target draw_list_render_target(Draw_List* draw_list) {
+    return (Fou_Render_Target){.functions = &render_functions, .context = draw_list};
+}
+
+void draw_list_triple_init(Draw_List_Triple* triple) {
+    for (int i = 0; i < 3; i++) {
+        draw_list_init(&triple->lists[i]);
+    }
+    triple_buffer_init(&triple->buffer);
+}
+
+void draw_list_triple_free(Draw_List_Triple* triple) {
+    for (int i = 0; i < 3; i++) {
+        draw_list_free(&triple->lists[i]);
+    }
+}
+
+Draw_List* draw_list_triple_writing(Draw_List_Triple* triple) {
+    return &triple->lists[triple->buffer.writing];
+}
+
+void draw_list_triple_publish(Draw_List_Triple* triple) {
+    triple_buffer_publish(&triple->buffer);
+}
+
+const Draw_List* draw_list_triple_read(Draw_List_Triple* triple) {
+    return &triple->lists[triple_buffer_read(&triple->buffer)];
+}
+
+Draw_List_Stats draw_list_triple_stats(const Draw_List_Triple* triple) {
+    Draw_List_Stats total = {0};
+    for (int i = 0; i < 3; i++) {
+        const Draw_List_Stats* stats = &triple->lists[i].stats;
+        if (stats->peak_bytes > total.peak_bytes) total.peak_bytes = stats->peak_bytes;
+        if (stats->peak_calls > total.peak_calls) total.peak_calls = stats->peak_calls;
+        if (stats->peak_string_bytes > total.peak_string_bytes) {
+            total.peak_string_bytes = stats->peak_string_bytes;
+        }
+        total.dropped_low += stats->dropped_low;
+        total.dropped_normal += stats->dropped_normal;
+    }
+    return total;
+}
@@ -0,0 +1,158 @@
+/*
+ * Recorded fou_draw_* calls, replayed later by whatever actually owns the
+ * screen.
+ *
+ * The game thread records a frame while the GUI thread replays the previous
+ * one, so draw lists are handed over through a triple buffer, see
+ * triple_buffer.h.
+ */
+
+#ifndef DRAW_LIST_H
+#define DRAW_LIST_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "flouhou.h"
+#include "triple_buffer.h"
+
+typedef enum {
+    DRAW_CALL_FOU_DRAW_BOX,
+    DRAW_CALL_FOU_DRAW_DISC,
+    DRAW_CALL_FOU_DRAW_DOT,
+    DRAW_CALL_FOU_DRAW_FRAME,
+    DRAW_CALL_FOU_DRAW_ICON,
+    DRAW_CALL_FOU_DRAW_OUTLINED_ICON, // uses fou_draw_icon
+    DRAW_CALL_FOU_DRAW_STR,
+    DRAW_CALL_FOU_DRAW_OUTLINED_STR, // see FOU_STR_OUTLINED, uses fou_draw_str
+    DRAW_CALL_FOU_INVERT_COLOR,
+    DRAW_CALL_FOU_SET_BITMAP_MODE,
+    DRAW_CALL_FOU_SET_COLOR,
+} Draw_Call_Kind;
+
+typedef struct {
+    Draw_Call_Kind kind;
+    union {
+        struct {int x; int y; int width; int height;} fou_draw_box;
+        struct {int x; int y; int radius;} fou_draw_disc;
+        struct {int x; int y;} fou_draw_dot;
+        struct {int x; int y; int width; int height;} fou_draw_frame;
+        struct {int x; int y; Fou_Icon icon;} fou_draw_icon;
+        // into the arena, or a static string that was never copied
+        struct {int x; int y; const char* string;} fou_draw_str;
+        struct {;} fou_invert_color;
+        struct {bool alpha;} fou_set_bitmap_mode;
+        struct {bool color;} fou_set_color;
+    };
+} Draw_Call;
+
+// The arena budget. Every pew is an outlined icon, one call, every particle
+// one call, every drone 7 calls. The background and stars drawn before them
+// take 16 calls, everything else stays below 64 calls. The player and the
+// enemies are drawn before the enemy pews, low priority draws need room for
+// them on top of the normal reserve, another 32 + 7 calls per drone.
+// host/fou_bench measures a peak of ~240 calls in the dense_fire scenario and
+// less than 16 bytes of HUD strings, static strings take no room.
+#ifndef DRAW_LIST_BUDGET_CALLS
+#define DRAW_LIST_BUDGET_CALLS \
+    (PEW_CAP + ENEMY_PEW_CAP + 7 * 2 * ENEMY_CAP + PARTICLE_CAP + 16 + 32 + 64)
+#endif
+#define DRAW_LIST_BUDGET_STRING_BYTES 128
+#define DRAW_LIST_ARENA_SIZE \
+    (sizeof(Draw_Call) * DRAW_LIST_BUDGET_CALLS + DRAW_LIST_BUDGET_STRING_BYTES)
+/// Part of the arena low priority draws are not allowed to use, enough for
+/// the player, the enemies and the HUD that are drawn after the pews.
+#define DRAW_LIST_NORMAL_RESERVE (sizeof(Draw_Call) * (64 + 7 * ENEMY_CAP) + 64)
+/// Most calls a list can ever hold, when there are no strings at all.
+#define MAX_DRAW_CALLS (DRAW_LIST_ARENA_SIZE / sizeof(Draw_Call))
+
+typedef struct {
+    size_t peak_bytes; // calls and strings together
+    size_t peak_calls;
+    size_t peak_string_bytes;
+    // totals since the list was initialized
+    unsigned long dropped_low;
+    unsigned long dropped_normal;
+} Draw_List_Stats;
+
+/// A frame of recorded calls. Calls and the bytes of the strings they draw
+/// share a single fixed arena allocated by draw_list_init: calls grow up from
+/// its start, strings grow down from its end. Clearing is O(1) and recording
+/// never allocates.
+typedef struct {
+    char* arena;
+    struct {
+        Draw_Call* items; // start of the arena
+        size_t size;
+    } calls;
+    size_t strings_start; // arena offset of the lowest string byte
+    Fou_Draw_Priority priority; // of the calls pushed next
+    Draw_List_Stats stats;
+} Draw_List;
+
+void draw_list_init(Draw_List* draw_list);
+
+void draw_list_free(Draw_List* draw_list);
+
+/// Start recording a new frame, keeps the stats.
+void draw_list_clear(Draw_List* draw_list);
+
+/// Append `draw_call` if there is room for it. Draws are dropped rather than
+/// state changes: when the arena runs full, draws pushed at
+/// FOU_DRAW_PRIORITY_LOW go first while the rest of the arena is kept for
+/// normal priority ones. Returns false if the call was dropped.
+bool draw_list_push_call(Draw_List* draw_list, Draw_Call draw_call);
+
+/// Append a DRAW_CALL_FOU_DRAW_STR or, with FOU_STR_OUTLINED, a
+/// DRAW_CALL_FOU_DRAW_OUTLINED_STR call. `string` is copied into the arena
+/// unless it is FOU_STR_STATIC.
+bool draw_list_push_str(
+    Draw_List* draw_list,
+    int x,
+    int y,
+    const char* string,
+    Fou_Str_Flags flags);
+
+/// Whether `string`, of a string call of `draw_list`, is a copy in its arena
+/// rather than a static string.
+static inline bool draw_list_owns_string(const Draw_List* draw_list, const char* string) {
+    uintptr_t offset = (uintptr_t)string - (uintptr_t)draw_list->arena;
+    return offset < DRAW_LIST_ARENA_SIZE;
+}
+
+/// A render target recording into `draw_list`.
+Fou_Render_Target draw_list_render_target(Draw_List* draw_list);
+
+/// Bounding box of everything a draw call may touch. Returns false for calls
+/// that only change state.
+bool draw_call_bounds(const Draw_Call* draw_call, Rect* bounds);
+
+/// How many calls fit into the list without overwriting its strings.
+static inline size_t draw_list_call_capacity(const Draw_List* draw_list) {
+    return draw_list->strings_start / sizeof(Draw_Call);
+}
+
+typedef struct {
+    Draw_List lists[3];
+    Triple_Buffer buffer;
+} Draw_List_Triple;
+
+void draw_list_triple_init(Draw_List_Triple* triple);
+
+void draw_list_triple_free(Draw_List_Triple* triple);
+
+/// The list the writer records the next frame into.
+Draw_List* draw_list_triple_writing(Draw_List_Triple* triple);
+
+/// Hand the frame that was just recorded over to the reader.
+void draw_list_triple_publish(Draw_List_Triple* triple);
+
+/// The list the reader should replay: the latest published frame, or the one
+/// it already replayed last time if nothing new has been published since.
+const Draw_List* draw_list_triple_read(Draw_List_Triple* triple);
+
+/// Stats of all three lists combined. Only call this from the writer.
+Draw_List_Stats draw_list_triple_stats(const Draw_List_Triple* triple);
+
+#endif
@@ -0,0 +1,154 @@
+#include <string.h>
+
+#include "draw_opt.h"
+
+// Draw_Opt_State.color is either relative to whatever color the canvas had
+// when the list started (the parity of the inverts so far) or absolute once a
+// color has been set.
+#define COLOR_RELATIVE(parity) (parity)
+#define COLOR_ABSOLUTE(color) (2 + (color))
+#define COLOR_IS_ABSOLUTE(c) ((c) >= 2)
+
+#define SCREEN_WIDTH 128
+#define SCREEN_HEIGHT 64
+
+static bool overlaps(Rect a, Rect b) {
+    return (a.x + a.w) > b.x && a.x < (b.x + b.w) && (a.y + a.h) > b.y && a.y < (b.y + b.h);
+}
+
+static bool same_state(Draw_Opt_State a, Draw_Opt_State b) {
+    return a.color == b.color && a.bitmap_mode == b.bitmap_mode;
+}
+
+/// Append the calls needed to get from state `from` to state `to`, at most
+/// two.
+static int emit_state_change(Draw_Call* out, int len, Draw_Opt_State* from, Draw_Opt_State to) {
+    if (from->color != to.color) {
+        if (COLOR_IS_ABSOLUTE(to.color)) {
+            out[len++] = (Draw_Call){
+                .kind = DRAW_CALL_FOU_SET_COLOR,
+                .fou_set_color.color = to.color - COLOR_ABSOLUTE(0)};
+        } else {
+            // both relative, so they differ by exactly one invert
+            out[len++] = (Draw_Call){.kind = DRAW_CALL_FOU_INVERT_COLOR};
+        }
+        from->color = to.color;
+    }
+    if (from->bitmap_mode != to.bitmap_mode) {
+        out[len++] = (Draw_Call){
+            .kind = DRAW_CALL_FOU_SET_BITMAP_MODE, .fou_set_bitmap_mode.alpha = to.bitmap_mode};
+        from->bitmap_mode = to.bitmap_mode;
+    }
+    return len;
+}
+
+static int leave_unchanged(Draw_Optimizer* optimizer, int len) {
+    optimizer->stats = (Draw_Opt_Stats){.calls_in = len, .calls_out = len};
+    return 0;
+}
+
+int draw_list_optimize(Draw_Optimizer* optimizer, Draw_List* draw_list) {
+    Draw_Opt_Stats stats = {.calls_in = draw_list->calls.size};
+    Draw_Call* calls = draw_list->calls.items;
+    int len = draw_list->calls.size;
+    Rect* bounds = optimizer->bounds; // indexed like `calls`
+
+    Draw_Opt_State state = {.color = COLOR_RELATIVE(0), .bitmap_mode = -1};
+    int batch_count = 0;
+    int draw_count = 0;
+    int state_calls_in = 0;
+
+    for (int i = 0; i < len; i++) {
+        const Draw_Call* dc = &calls[i];
+        switch (dc->kind) {
+            case DRAW_CALL_FOU_INVERT_COLOR:
+                state.color ^= 1; // flips relative parity and absolute color alike
+                state_calls_in++;
+                continue;
+            case DRAW_CALL_FOU_SET_COLOR:
+                state.color = COLOR_ABSOLUTE(dc->fou_set_color.color ? 1 : 0);
+                state_calls_in++;
+                continue;
+            case DRAW_CALL_FOU_SET_BITMAP_MODE:
+                state.bitmap_mode = dc->fou_set_bitmap_mode.alpha ? 1 : 0;
+                state_calls_in++;
+                continue;
+            default:
+                break;
+        }
+        Rect b;
+        draw_call_bounds(dc, &b);
+        if (!overlaps(b, (Rect){0, 0, SCREEN_WIDTH, SCREEN_HEIGHT})) {
+            stats.culled++;
+            continue;
+        }
+        bounds[i] = b;
+        optimizer->next[i] = -1;
+
+        // Look for an earlier batch with the same state that this draw can
+        // join without moving across anything it overlaps.
+        int target = -1;
+        int checks = 0;
+        int oldest = batch_count - DRAW_OPT_MAX_LOOKBACK_BATCHES;
+        for (int k = batch_count - 1; k >= 0 && k >= oldest; k--) {
+            Draw_Opt_Batch* batch = &optimizer->batches[k];
+            if (same_state(batch->state, state)) {
+                target = k;
+                break;
+            }
+            bool blocked = false;
+            for (int j = batch->first; j != -1; j = optimizer->next[j]) {
+                if (++checks > DRAW_OPT_MAX_OVERLAP_CHECKS || overlaps(bounds[j], b)) {
+                    blocked = true;
+                    break;
+                }
+            }
+            if (blocked) {
+                break;
+            }
+        }
+        if (target == -1) {
+            optimizer->batches[batch_count++] = (Draw_Opt_Batch){
+                .state = state, .first = i, .last = i};
+        } else {
+            Draw_Opt_Batch* batch = &optimizer->batches[target];
+            optimizer->next[batch->last] = i;
+            batch->last = i;
+            if (target != batch_count - 1) {
+                stats.batched++;
+            }
+        }
+        draw_count++;
+    }
+
+    // rebuild the list batch by batch, keeping room for the final state change
+    Draw_Call* out = optimizer->calls;
+    int out_len = 0;
+    int out_cap = (int)draw_list_call_capacity(draw_list) - 2;
+    if (out_cap < 0) {
+        return leave_unchanged(optimizer, len);
+    }
+    Draw_Opt_State emitted = {.color = COLOR_RELATIVE(0), .bitmap_mode = -1};
+    for (int k = 0; k < batch_count; k++) {
+        if (out_len + 2 > out_cap) {
+            return leave_unchanged(optimizer, len);
+        }
+        out_len = emit_state_change(out, out_len, &emitted, optimizer->batches[k].state);
+        for (int j = optimizer->batches[k].first; j != -1; j = optimizer->next[j]) {
+            if (out_len == out_cap) {
+                return leave_unchanged(optimizer, len);
+            }
+            out[out_len++] = calls[j];
+        }
+    }
+    // leave the canvas in the state the original list left it in
+    out_len = emit_state_change(out, out_len, &emitted, state);
+
+    memcpy(calls, out, sizeof(Draw_Call) * out_len);
+    draw_list->calls.size = out_len;
+
+    stats.calls_out = out_len;
+    stats.state_calls_removed = state_calls_in - (out_len - draw_count);
+    optimizer->stats = stats;
+    return stats.calls_in - stats.calls_out;
+}
@@ -0,0 +1,61 @@
+/*
+ * Peephole pass over a recorded Draw_List, run after fou_frame and before the
+ * list is replayed.
+ *
+ * The pass tracks the drawing state (color and bitmap mode) every draw would
+ * see and rebuilds the list so that
+ *   - inverts that cancel out and state sets that change nothing disappear,
+ *   - draws that are entirely outside of the 128x64 screen are dropped,
+ *   - draws that need the same state and do not overlap anything they would
+ *     be moved across are batched together, so the state only changes once
+ *     per batch.
+ * The replayed list produces the same pixels and leaves the canvas in the
+ * same state as the original one.
+ */
+
+#ifndef DRAW_OPT_H
+#define DRAW_OPT_H
+
+#include <stdint.h>
+
+#include "draw_list.h"
+
+/// How many earlier batches a draw may be moved back across.
+#define DRAW_OPT_MAX_LOOKBACK_BATCHES 8
+/// How many draws are checked for overlap before giving up on moving a draw.
+#define DRAW_OPT_MAX_OVERLAP_CHECKS 64
+
+typedef struct {
+    int calls_in;
+    int calls_out;
+    int culled; // draws outside of the screen
+    int state_calls_removed; // inverts, color and bitmap mode sets
+    int batched; // draws moved into an earlier batch
+} Draw_Opt_Stats;
+
+typedef struct {
+    int16_t color; // see draw_opt.c
+    int16_t bitmap_mode; // -1 if never set
+} Draw_Opt_State;
+
+typedef struct {
+    Draw_Opt_State state;
+    int16_t first;
+    int16_t last;
+} Draw_Opt_Batch;
+
+/// Scratch space for the pass, big enough for MAX_DRAW_CALLS calls.
+typedef struct {
+    Draw_Call calls[MAX_DRAW_CALLS];
+    Rect bounds[MAX_DRAW_CALLS];
+    int16_t next[MAX_DRAW_CALLS]; // next draw in the same batch
+    Draw_Opt_Batch batches[MAX_DRAW_CALLS];
+    Draw_Opt_Stats stats; // of the last optimized list
+} Draw_Optimizer;
+
+/// Optimize `draw_list` in place. Returns how many calls were removed. In the
+/// unlikely case that the rebuilt list would not fit next to the strings of
+/// the list, the list is left as it was.
+int draw_list_optimize(Draw_Optimizer* optimizer, Draw_List* draw_list);
+
+#endif
@@ -0,0 +1,296 @@
+#include "emitter.h"
+
+#define TURNS(n) (n) // 1/256 turn operands, just to make patterns readable
+
+static const uint8_t pattern_none[] = {
+    EMIT_WAIT, 255,
+    EMIT_END,
+};
+
+// the original attack: a single shot at the player whenever the cooldown is up
+static const uint8_t pattern_aimed[] = {
+    EMIT_AIMED, 1, 0,
+    EMIT_WAIT_COOLDOWN,
+    EMIT_END,
+};
+
+static const uint8_t pattern_aimed_fan[] = {
+    EMIT_AIMED, 3, TURNS(10),
+    EMIT_WAIT_COOLDOWN,
+    EMIT_AIMED, 1, 0,
+    EMIT_WAIT_COOLDOWN,
+    EMIT_END,
+};
+
+static const uint8_t pattern_rings[] = {
+    EMIT_SPEED, 12,
+    EMIT_WAIT_COOLDOWN,
+    EMIT_WAIT_COOLDOWN,
+    EMIT_RING, 8,
+    EMIT_TURN, TURNS(16),
+    EMIT_WAIT_COOLDOWN,
+    EMIT_END,
+};
+
+static const uint8_t pattern_spiral[] = {
+    EMIT_SPEED, 14,
+    EMIT_LOOP, 12,
+        EMIT_RING, 3,
+        EMIT_TURN, TURNS(7),
+        EMIT_WAIT, 4,
+    EMIT_NEXT,
+    EMIT_WAIT_COOLDOWN,
+    EMIT_END,
+};
+
+static const uint8_t pattern_aimed_burst[] = {
+    EMIT_SPEED, 20,
+    EMIT_WAIT_COOLDOWN,
+    EMIT_LOOP, 4,
+        EMIT_AIMED, 1, 0,
+        EMIT_WAIT, 3,
+    EMIT_NEXT,
+    EMIT_WAIT_COOLDOWN,
+    EMIT_END,
+};
+
+static const uint8_t pattern_double_spiral[] = {
+    EMIT_SPEED, 12,
+    EMIT_LOOP, 16,
+        EMIT_FAN, 2, TURNS(128),
+        EMIT_TURN, TURNS(249),
+        EMIT_WAIT, 2,
+    EMIT_NEXT,
+    EMIT_WAIT_COOLDOWN,
+    EMIT_WAIT_COOLDOWN,
+    EMIT_END,
+};
+
+// slow rings that speed up once they are on their way
+static const uint8_t pattern_accelerating_ring[] = {
+    EMIT_BEHAVIOR, ENEMY_PEW_ACCELERATING, 3, 24,
+    EMIT_SPEED, 4,
+    EMIT_RING, 10,
+    EMIT_TURN, TURNS(13),
+    EMIT_WAIT_COOLDOWN,
+    EMIT_WAIT_COOLDOWN,
+    EMIT_END,
+};
+
+static const uint8_t pattern_wave_fan[] = {
+    EMIT_BEHAVIOR, ENEMY_PEW_WAVE, 48, 0,
+    EMIT_AIMED, 3, TURNS(16),
+    EMIT_WAIT_COOLDOWN,
+    EMIT_END,
+};
+
+static const uint8_t pattern_homing[] = {
+    EMIT_BEHAVIOR, ENEMY_PEW_HOMING, 0, 40,
+    EMIT_SPEED, 10,
+    EMIT_AIMED, 1, 0,
+    EMIT_WAIT_COOLDOWN,
+    EMIT_WAIT_COOLDOWN,
+    EMIT_END,
+};
+
+// a shot at the player that bursts into a ring halfway there
+static const uint8_t pattern_split[] = {
+    EMIT_BEHAVIOR, ENEMY_PEW_SPLIT, 0, 28,
+    EMIT_SPEED, 12,
+    EMIT_AIMED, 1, 0,
+    EMIT_WAIT_COOLDOWN,
+    EMIT_WAIT_COOLDOWN,
+    EMIT_END,
+};
+
+static const uint8_t* const patterns[EMITTER_PATTERN_COUNT] = {
+    [EMITTER_PATTERN_NONE] = pattern_none,
+    [EMITTER_PATTERN_AIMED] = pattern_aimed,
+    [EMITTER_PATTERN_AIMED_FAN] = pattern_aimed_fan,
+    [EMITTER_PATTERN_RINGS] = pattern_rings,
+    [EMITTER_PATTERN_SPIRAL] = pattern_spiral,
+    [EMITTER_PATTERN_AIMED_BURST] = pattern_aimed_burst,
+    [EMITTER_PATTERN_DOUBLE_SPIRAL] = pattern_double_spiral,
+    [EMITTER_PATTERN_ACCELERATING_RING] = pattern_accelerating_ring,
+    [EMITTER_PATTERN_WAVE_FAN] = pattern_wave_fan,
+    [EMITTER_PATTERN_HOMING] = pattern_homing,
+    [EMITTER_PATTERN_SPLIT] = pattern_split,
+};
+
+/// Enemy emitter setup that takes over once the enemy has taken `min_hits`.
+typedef struct {
+    int min_hits;
+    uint8_t patterns[EMITTERS_PER_ENEMY]; // Emitter_Pattern
+} Emitter_Stage;
+
+/// Sorted by `min_hits`.
+static const Emitter_Stage stages[] = {
+    {.min_hits = 0, .patterns = {EMITTER_PATTERN_AIMED, EMITTER_PATTERN_NONE}},
+    {.min_hits = 10, .patterns = {EMITTER_PATTERN_AIMED_FAN, EMITTER_PATTERN_HOMING}},
+    {.min_hits = 20, .patterns = {EMITTER_PATTERN_WAVE_FAN, EMITTER_PATTERN_RINGS}},
+    {.min_hits = 35, .patterns = {EMITTER_PATTERN_AIMED_BURST, EMITTER_PATTERN_SPIRAL}},
+    {.min_hits = 50, .patterns = {EMITTER_PATTERN_AIMED_FAN, EMITTER_PATTERN_DOUBLE_SPIRAL}},
+    {.min_hits = 65, .patterns = {EMITTER_PATTERN_SPLIT, EMITTER_PATTERN_ACCELERATING_RING}},
+};
+
+#define STAGE_COUNT (int)(sizeof(stages) / sizeof(stages[0]))
+
+int emitter_stage_for_hits(int hits) {
+    int stage = 0;
+    while (stage + 1 < STAGE_COUNT && stages[stage + 1].min_hits <= hits) {
+        stage++;
+    }
+    return stage;
+}
+
+void emitter_stage_start(Emitter* emitters, int stage, int initial_wait) {
+    for (int i = 0; i < EMITTERS_PER_ENEMY; i++) {
+        emitter_start(&emitters[i], stages[stage].patterns[i], initial_wait);
+    }
+}
+
+void emitter_start(Emitter* emitter, Emitter_Pattern pattern, int initial_wait) {
+    *emitter = (Emitter){
+        .pattern = pattern,
+        .pc = 0,
+        .speed = 16,
+        .loop_depth = 0,
+        .wait = initial_wait,
+        .angle = FOU_ANGLE_DEGREES(180), // towards the player side
+        .behavior = ENEMY_PEW_STRAIGHT,
+        .behavior_param = 0,
+        .behavior_ticks = 0,
+    };
+}
+
+/// Spawn `count` pews flying in direction (dir_x, dir_y) rotated by
+/// `first_angle`, `first_angle + step`, ...
+/// The direction must already have the length of the pew speed.
+static void spawn_fan(
+    const Emitter* emitter,
+    const Emitter_Context* context,
+    Enemy_Pews* enemy_pews,
+    Fou_Num dir_x,
+    Fou_Num dir_y,
+    int count,
+    Fou_Angle first_angle,
+    Fou_Angle step)
+{
+    int first;
+    count = enemypew_reserve(enemy_pews, emitter->behavior, count, &first);
+    Fou_Num param = fou_num_from_int(emitter->behavior_param) / 64;
+    Fou_Angle angle = first_angle;
+    for (int i = first; i < first + count; i++) {
+        Fou_Num c = fou_cos(angle);
+        Fou_Num s = fou_sin(angle);
+        enemy_pews->x[i] = fou_coord_from_num(context->x);
+        enemy_pews->y[i] = fou_coord_from_num(context->y);
+        enemy_pews->h_speed[i] = fou_num_mul(dir_x, c) - fou_num_mul(dir_y, s);
+        enemy_pews->v_speed[i] = fou_num_mul(dir_x, s) + fou_num_mul(dir_y, c);
+        enemy_pews->param[i] = param;
+        enemy_pews->ticks[i] = emitter->behavior_ticks;
+        angle += step;
+    }
+}
+
+static Fou_Num scaled_speed(const Emitter* emitter, const Emitter_Context* context) {
+    return context->pew_speed * emitter->speed / 16;
+}
+
+void emitter_tick(Emitter* emitter, const Emitter_Context* context, Enemy_Pews* enemy_pews) {
+    if (emitter->wait > 0) {
+        emitter->wait--;
+        return;
+    }
+    const uint8_t* program = patterns[emitter->pattern];
+    for (int ops = 0; ops < EMITTER_MAX_OPS_PER_TICK; ops++) {
+        const uint8_t* op = &program[emitter->pc];
+        switch ((Emitter_Op)op[0]) {
+            case EMIT_END: {
+                emitter->pc = 0;
+                emitter->loop_depth = 0;
+            } break;
+            case EMIT_AIMED: {
+                int count = op[1];
+                Fou_Angle spread = op[2] << 8;
+                Fou_Num dir_x = context->target_x - context->x;
+                Fou_Num dir_y = context->target_y - context->y;
+                fou_vector_set_length(&dir_x, &dir_y, scaled_speed(emitter, context));
+                Fou_Angle first = (Fou_Angle)(-(spread * (count - 1)) / 2);
+                spawn_fan(emitter, context, enemy_pews, dir_x, dir_y, count, first, spread);
+                emitter->pc += 3;
+            } break;
+            case EMIT_FAN: {
+                int count = op[1];
+                Fou_Angle spread = op[2] << 8;
+                Fou_Angle first = (Fou_Angle)(emitter->angle - (spread * (count - 1)) / 2);
+                spawn_fan(
+                    emitter,
+                    context,
+                    enemy_pews,
+                    scaled_speed(emitter, context),
+                    0,
+                    count,
+                    first,
+                    spread);
+                emitter->pc += 3;
+            } break;
+            case EMIT_RING: {
+                int count = op[1];
+                spawn_fan(
+                    emitter,
+                    context,
+                    enemy_pews,
+                    scaled_speed(emitter, context),
+                    0,
+                    count,
+                    emitter->angle,
+                    (Fou_Angle)(0x10000 / count));
+                emitter->pc += 2;
+            } break;
+            case EMIT_TURN: {
+                emitter->angle += op[1] << 8;
+                emitter->pc += 2;
+            } break;
+            case EMIT_SPEED: {
+                emitter->speed = op[1];
+                emitter->pc += 2;
+            } break;
+            case EMIT_BEHAVIOR: {
+                emitter->behavior = op[1];
+                emitter->behavior_param = op[2];
+                emitter->behavior_ticks = op[3];
+                emitter->pc += 4;
+            } break;
+            case EMIT_WAIT: {
+                emitter->wait = op[1];
+                emitter->pc += 2;
+                return;
+            }
+            case EMIT_WAIT_COOLDOWN: {
+                emitter->wait = context->cooldown;
+                emitter->pc += 1;
+                return;
+            }
+            case EMIT_LOOP: {
+                emitter->pc += 2;
+                if (emitter->loop_depth < EMITTER_MAX_LOOP_DEPTH) {
+                    emitter->loops[emitter->loop_depth].start = emitter->pc;
+                    emitter->loops[emitter->loop_depth].left = op[1];
+                    emitter->loop_depth++;
+                }
+            } break;
+            case EMIT_NEXT: {
+                emitter->pc += 1;
+                if (emitter->loop_depth > 0) {
+                    int top = emitter->loop_depth - 1;
+                    if (--emitter->loops[top].left > 0) {
+                        emitter->pc = emitter->loops[top].start;
+                    } else {
+                        emitter->loop_depth--;
+                    }
+                }
+            } break;
+        }
+    }
+}
@@ -0,0 +1,110 @@
+/*
+ * Bullet emitters driven by small bytecode patterns.
+ *
+ * A pattern is a byte string of ops followed by their operands. Emitters only
+ * store the index of their pattern and a few registers, so every emitter has
+ * the same fixed size and a Game_State containing them can be copied freely.
+ *
+ * Ops and operands:
+ *
+ *   EMIT_AIMED n, spread     n pews fanned around the direction to the target,
+ *                            `spread` 1/256 turns apart
+ *   EMIT_FAN n, spread       n pews fanned around the angle register
+ *   EMIT_RING n              n pews evenly spaced around a full turn, starting
+ *                            at the angle register
+ *   EMIT_TURN delta          add `delta` 1/256 turns to the angle register
+ *   EMIT_SPEED s             pew speed in 1/16 of the per-hit pew speed
+ *   EMIT_BEHAVIOR b, p, t    the Enemy_Pew_Behavior b of the pews spawned from
+ *                            now on, with a `param` of p/64 and `ticks` t
+ *   EMIT_WAIT n              do nothing for the next n ticks
+ *   EMIT_WAIT_COOLDOWN       wait for the per-hit shoot cooldown
+ *   EMIT_LOOP n ... EMIT_NEXT
+ *                            run the enclosed ops n times
+ *   EMIT_END                 start the pattern over
+ */
+
+#ifndef EMITTER_H
+#define EMITTER_H
+
+#include <stdint.h>
+
+#include "fou_math.h"
+#include "pew.h"
+
+#define EMITTERS_PER_ENEMY 2
+#define EMITTER_MAX_LOOP_DEPTH 2
+/// Ops an emitter may run in a single tick, stops patterns without waits
+/// from spinning forever.
+#define EMITTER_MAX_OPS_PER_TICK 32
+
+typedef enum {
+    EMIT_END,
+    EMIT_AIMED,
+    EMIT_FAN,
+    EMIT_RING,
+    EMIT_TURN,
+    EMIT_SPEED,
+    EMIT_BEHAVIOR,
+    EMIT_WAIT,
+    EMIT_WAIT_COOLDOWN,
+    EMIT_LOOP,
+    EMIT_NEXT,
+} Emitter_Op;
+
+typedef enum {
+    EMITTER_PATTERN_NONE,
+    EMITTER_PATTERN_AIMED,
+    EMITTER_PATTERN_AIMED_FAN,
+    EMITTER_PATTERN_RINGS,
+    EMITTER_PATTERN_SPIRAL,
+    EMITTER_PATTERN_AIMED_BURST,
+    EMITTER_PATTERN_DOUBLE_SPIRAL,
+    EMITTER_PATTERN_ACCELERATING_RING,
+    EMITTER_PATTERN_WAVE_FAN,
+    EMITTER_PATTERN_HOMING,
+    EMITTER_PATTERN_SPLIT,
+    EMITTER_PATTERN_COUNT,
+} Emitter_Pattern;
+
+typedef struct {
+    uint8_t pattern; // Emitter_Pattern
+    uint8_t pc;
+    uint8_t speed; // in 1/16 of the per-hit pew speed
+    uint8_t loop_depth;
+    uint16_t wait;
+    Fou_Angle angle;
+    struct {
+        uint8_t start;
+        uint8_t left;
+    } loops[EMITTER_MAX_LOOP_DEPTH];
+    // of the pews spawned, see EMIT_BEHAVIOR
+    uint8_t behavior; // Enemy_Pew_Behavior
+    uint8_t behavior_param;
+    uint16_t behavior_ticks;
+} Emitter;
+
+/// Everything an emitter needs to know about the world for one tick.
+typedef struct {
+    Fou_Num x; // where pews are spawned
+    Fou_Num y;
+    Fou_Num target_x; // what aimed pews fly towards
+    Fou_Num target_y;
+    Fou_Num pew_speed;
+    int cooldown;
+} Emitter_Context;
+
+/// Reset `emitter` to the start of `pattern`. The first op runs after
+/// `initial_wait` ticks.
+void emitter_start(Emitter* emitter, Emitter_Pattern pattern, int initial_wait);
+
+/// Advance the emitter by one tick, spawning pews into `enemy_pews`.
+void emitter_tick(Emitter* emitter, const Emitter_Context* context, Enemy_Pews* enemy_pews);
+
+/// Index of the enemy stage that applies after it has taken `hits` hits.
+/// Each stage runs its own set of patterns.
+int emitter_stage_for_hits(int hits);
+
+/// Restart all EMITTERS_PER_ENEMY `emitters` with the patterns of `stage`.
+void emitter_stage_start(Emitter* emitters, int stage, int initial_wait);
+
+#endif
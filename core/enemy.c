@@ -0,0 +1,165 @@
+#include "enemy.h"
+#include "pool.h"
+
+/// A wave of `count` drones on the same path, spawned one after the other.
+typedef struct {
+    uint8_t count;
+    uint8_t interval; // ticks between two drones
+    uint8_t health;
+    uint8_t pattern; // Emitter_Pattern of every drone
+    uint8_t initial_wait; // before a drone's first shot
+    uint16_t pause; // ticks after the last drone before the next wave
+    Fou_Num y_step; // every drone starts this much lower than the one before
+    Enemy_Path path;
+} Enemy_Wave;
+
+// Drones come in from the right edge of the screen, below and above the boss'
+// loop, and retire once they left the screen again.
+static const Enemy_Wave waves[] = {
+    {
+        .count = 4,
+        .interval = 12,
+        .health = 2,
+        .pattern = EMITTER_PATTERN_AIMED,
+        .initial_wait = 24,
+        .pause = 160,
+        .path = {.kind = ENEMY_PATH_LINE, .x = FOU_NUM(128), .y = FOU_NUM(6),
+                 .dx = FOU_NUM(-0.75)},
+    },
+    {
+        .count = 5,
+        .interval = 10,
+        .health = 2,
+        .pattern = EMITTER_PATTERN_WAVE_FAN,
+        .initial_wait = 40,
+        .pause = 160,
+        .path = {.kind = ENEMY_PATH_LINE, .x = FOU_NUM(128), .y = FOU_NUM(28),
+                 .dx = FOU_NUM(-0.5), .amplitude = FOU_NUM(14), .turn = 0x10000 / 96},
+    },
+    {
+        .count = 3,
+        .interval = 4,
+        .health = 3,
+        .pattern = EMITTER_PATTERN_SPLIT,
+        .initial_wait = 32,
+        .pause = 200,
+        .y_step = FOU_NUM(12),
+        .path = {.kind = ENEMY_PATH_LINE, .x = FOU_NUM(128), .y = FOU_NUM(40),
+                 .dx = FOU_NUM(-0.625), .dy = FOU_NUM(-0.125)},
+    },
+};
+
+#define WAVE_COUNT (int)(sizeof(waves) / sizeof(waves[0]))
+#define FIRST_WAVE_DELAY 240
+
+void enemies_init(Enemies* enemies) {
+    enemies->len = 0;
+    enemies->dropped = 0;
+    for (int i = 0; i < ENEMY_CAP; i++) {
+        enemies->slot[i] = i;
+        enemies->generation[i] = 0;
+        enemies->index[i] = i;
+    }
+}
+
+Enemy_Handle enemy_spawn(
+    Enemies* enemies,
+    Enemy_Kind kind,
+    int health,
+    Enemy_Path path,
+    int tick)
+{
+    if (enemies->len == ENEMY_CAP) {
+        enemies->dropped++;
+        return ENEMY_HANDLE_NONE;
+    }
+    int i = enemies->len++;
+    uint8_t slot = enemies->slot[i];
+    enemies->index[slot] = i;
+    Position position = enemy_path_position(&path, 0);
+    enemies->kind[i] = kind;
+    enemies->hit_cooldown[i] = 0;
+    enemies->health[i] = health;
+    enemies->stage[i] = 0;
+    enemies->hits_taken[i] = 0;
+    enemies->spawn_tick[i] = tick;
+    enemies->x[i] = position.x;
+    enemies->y[i] = position.y;
+    enemies->path[i] = path;
+    for (int e = 0; e < EMITTERS_PER_ENEMY; e++) {
+        emitter_start(&enemies->emitters[i][e], EMITTER_PATTERN_NONE, 0);
+    }
+    return enemy_handle(enemies, i);
+}
+
+void enemy_retire(Enemies* enemies, int index) {
+    uint8_t slot = enemies->slot[index];
+    enemies->generation[slot]++;
+    int last = --enemies->len;
+    // the freed slot goes right behind the live ones
+    enemies->slot[index] = enemies->slot[last];
+    enemies->slot[last] = slot;
+    enemies->index[enemies->slot[index]] = index;
+    if (index == last) return;
+    // every field by index, `slot` is swapped above
+    Pool_Field fields[] = {
+        POOL_FIELD(enemies->kind),
+        POOL_FIELD(enemies->hit_cooldown),
+        POOL_FIELD(enemies->health),
+        POOL_FIELD(enemies->stage),
+        POOL_FIELD(enemies->hits_taken),
+        POOL_FIELD(enemies->spawn_tick),
+        POOL_FIELD(enemies->x),
+        POOL_FIELD(enemies->y),
+        POOL_FIELD(enemies->path),
+        POOL_FIELD(enemies->emitters),
+    };
+    pool_move_slot(fields, POOL_FIELD_COUNT(fields), last, index);
+}
+
+static Fou_Num map(Fou_Num src_min, Fou_Num src_max, Fou_Num dst_min, Fou_Num dst_max, Fou_Num x) {
+    Fou_Num src_range = src_max - src_min;
+    Fou_Num dst_range = dst_max - dst_min;
+    return fou_num_mul(fou_num_div(x - src_min, src_range), dst_range) + dst_min;
+}
+
+Position enemy_path_position(const Enemy_Path* path, int age) {
+    if (path->kind == ENEMY_PATH_LOOP) {
+        Fou_Num x;
+        Fou_Num y;
+        fou_enemy_path(age, &x, &y);
+        return (Position){
+            .x = map(FOU_NUM(-1), FOU_NUM(1), path->x, path->x + path->dx, x),
+            .y = map(FOU_NUM(-1), FOU_NUM(1), path->y, path->y + path->dy, y),
+        };
+    }
+    Position position = {.x = path->x + path->dx * age, .y = path->y + path->dy * age};
+    if (path->amplitude != 0) {
+        position.y += fou_num_mul(path->amplitude, fou_sin((Fou_Angle)(path->turn * age)));
+    }
+    return position;
+}
+
+void enemy_waves_start(Enemy_Waves* waves, int tick) {
+    *waves = (Enemy_Waves){.wave = 0, .spawned = 0, .next_tick = tick + FIRST_WAVE_DELAY};
+}
+
+void enemy_waves_tick(Enemy_Waves* waves_state, Enemies* enemies, int tick) {
+    if (tick < waves_state->next_tick) return;
+    const Enemy_Wave* wave = &waves[waves_state->wave];
+    Enemy_Path path = wave->path;
+    path.y += wave->y_step * waves_state->spawned;
+    Enemy_Handle handle = enemy_spawn(enemies, ENEMY_KIND_DRONE, wave->health, path, tick);
+    int index = enemy_index(enemies, handle);
+    if (index >= 0) {
+        emitter_start(&enemies->emitters[index][0], wave->pattern, wave->initial_wait);
+    }
+    waves_state->spawned++;
+    if (waves_state->spawned < wave->count) {
+        waves_state->next_tick = tick + wave->interval;
+    } else {
+        waves_state->next_tick = tick + wave->pause;
+        waves_state->spawned = 0;
+        waves_state->wave = (waves_state->wave + 1) % WAVE_COUNT;
+    }
+}
@@ -0,0 +1,135 @@
+/*
+ * Enemies: the boss and the waves of drones that fly past it.
+ *
+ * Enemies are stored like the bullets of pew.h, one array per field with the
+ * live enemies at [0, len), so a tick updates all of them in a single pass
+ * over a few dense arrays. Retiring an enemy moves the last one into its
+ * place. Indices change when that happens, anything that refers to an enemy
+ * for longer than a tick keeps an Enemy_Handle instead: the slot the enemy
+ * owns for its whole life, and the generation of that slot, which goes up
+ * every time the slot's enemy retires. A handle of a retired enemy never
+ * finds the enemy that was spawned into its slot later, at least until the 8
+ * bit generation wraps around.
+ *
+ * Enemies have no velocity. Their path is a closed form of the ticks since
+ * they were spawned, so they can be drawn anywhere between two ticks.
+ */
+
+#ifndef ENEMY_H
+#define ENEMY_H
+
+#include <stdint.h>
+
+#include "emitter.h"
+#include "fixed.h"
+#include "fou_math.h"
+
+#ifndef ENEMY_CAP
+#define ENEMY_CAP 16
+#endif
+
+_Static_assert(ENEMY_CAP <= 255, "slots are 8 bit, 255 is no slot at all");
+
+typedef struct {
+    Fou_Num x;
+    Fou_Num y;
+} Position;
+
+typedef enum {
+    ENEMY_KIND_BOSS,
+    ENEMY_KIND_DRONE,
+    ENEMY_KIND_COUNT,
+} Enemy_Kind;
+
+typedef enum {
+    /// fou_enemy_path, scaled into the box at (x, y) of size (dx, dy).
+    ENEMY_PATH_LOOP,
+    /// From (x, y), moving (dx, dy) every tick. A non-zero `amplitude` swings
+    /// it up and down by that much, `turn` further along the swing every tick.
+    ENEMY_PATH_LINE,
+} Enemy_Path_Kind;
+
+typedef struct {
+    uint8_t kind; // Enemy_Path_Kind
+    Fou_Angle turn;
+    Fou_Num x;
+    Fou_Num y;
+    Fou_Num dx;
+    Fou_Num dy;
+    Fou_Num amplitude;
+} Enemy_Path;
+
+typedef struct {
+    uint8_t slot;
+    uint8_t generation;
+} Enemy_Handle;
+
+#define ENEMY_HANDLE_NONE ((Enemy_Handle){.slot = 255, .generation = 0})
+
+typedef struct {
+    int len;
+    int dropped; // amount of enemies that did not fit
+    // by index, for the enemies at [0, len). slot[len, ENEMY_CAP) are the
+    // slots that are free.
+    uint8_t slot[ENEMY_CAP];
+    uint8_t kind[ENEMY_CAP]; // Enemy_Kind
+    uint8_t hit_cooldown[ENEMY_CAP]; // ticks the enemy can't be hit and flickers
+    uint8_t health[ENEMY_CAP]; // hits until the enemy retires, 0 for never
+    uint8_t stage[ENEMY_CAP]; // see emitter_stage_for_hits
+    int hits_taken[ENEMY_CAP];
+    int spawn_tick[ENEMY_CAP];
+    Fou_Num x[ENEMY_CAP]; // position as of the last tick's update
+    Fou_Num y[ENEMY_CAP];
+    Enemy_Path path[ENEMY_CAP];
+    Emitter emitters[ENEMY_CAP][EMITTERS_PER_ENEMY];
+    // by slot
+    uint8_t generation[ENEMY_CAP];
+    uint8_t index[ENEMY_CAP]; // of the slot's enemy, if it has one
+} Enemies;
+
+/// Spawns waves of drones one after the other, starting over after the last.
+typedef struct {
+    uint8_t wave;
+    uint8_t spawned; // drones of the current wave so far
+    int next_tick; // of the next spawn
+} Enemy_Waves;
+
+/// No enemies, every slot free.
+void enemies_init(Enemies* enemies);
+
+/// Add an enemy at `tick` with no emitters running. Returns ENEMY_HANDLE_NONE
+/// and counts the enemy as dropped if `enemies` is full.
+Enemy_Handle enemy_spawn(
+    Enemies* enemies,
+    Enemy_Kind kind,
+    int health,
+    Enemy_Path path,
+    int tick);
+
+/// Remove the enemy at `index`, the last enemy takes its place.
+void enemy_retire(Enemies* enemies, int index);
+
+static inline Enemy_Handle enemy_handle(const Enemies* enemies, int index) {
+    uint8_t slot = enemies->slot[index];
+    return (Enemy_Handle){.slot = slot, .generation = enemies->generation[slot]};
+}
+
+/// Index of the enemy `handle` refers to, -1 if it retired.
+static inline int enemy_index(const Enemies* enemies, Enemy_Handle handle) {
+    if (handle.slot >= ENEMY_CAP || enemies->generation[handle.slot] != handle.generation) {
+        return -1;
+    }
+    int index = enemies->index[handle.slot];
+    return index < enemies->len && enemies->slot[index] == handle.slot ? index : -1;
+}
+
+/// Where the enemy on `path` is `age` ticks after it was spawned.
+Position enemy_path_position(const Enemy_Path* path, int age);
+
+/// First wave at `tick`.
+void enemy_waves_start(Enemy_Waves* waves, int tick);
+
+/// Spawn the drones that are due at `tick`.
+void enemy_waves_tick(Enemy_Waves* waves, Enemies* enemies, int tick);
+
+#endif
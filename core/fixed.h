@@ -0,0 +1,169 @@
+/*
+ * Number type used for positions, velocities and everything derived from
+ * them in the simulation.
+ *
+ * By default it is a signed Q-format fixed point number, which only needs
+ * integer instructions and therefore gives bit-identical results on every
+ * platform. Build with FOU_FIXED_POINT=0 to get plain floats instead.
+ *
+ * The coordinates of what there are many of, bullets and particles, are
+ * stored as Fou_Coord: 16 bit fixed point with FOU_COORD_FRAC_BITS fraction
+ * bits, half the size of a Fou_Num and plenty for a 128x64 screen. They are
+ * converted to and from Fou_Num wherever they are computed with. With floats
+ * they are floats as well.
+ */
+
+#ifndef FIXED_H
+#define FIXED_H
+
+#include <stdint.h>
+
+#ifndef FOU_FIXED_POINT
+#define FOU_FIXED_POINT 1
+#endif
+
+#if FOU_FIXED_POINT
+
+#ifndef FOU_FIXED_FRAC_BITS
+#define FOU_FIXED_FRAC_BITS 16
+#endif
+
+typedef int32_t Fou_Num;
+
+#define FOU_NUM_ONE ((Fou_Num)1 << FOU_FIXED_FRAC_BITS)
+
+/// Convert a constant to Fou_Num, usable in constant expressions.
+#define FOU_NUM(x) ((Fou_Num)((x) * FOU_NUM_ONE + ((x) < 0 ? -0.5 : 0.5)))
+
+static inline Fou_Num fou_num_from_int(int i) {
+    return (Fou_Num)i * FOU_NUM_ONE;
+}
+
+static inline Fou_Num fou_num_from_float(float f) {
+    return (Fou_Num)(f * FOU_NUM_ONE + (f < 0 ? -0.5f : 0.5f));
+}
+
+/// Rounds towards negative infinity, so sub-pixel positions always map to
+/// the pixel they are in.
+static inline int fou_num_to_int(Fou_Num n) {
+    return n >> FOU_FIXED_FRAC_BITS;
+}
+
+static inline float fou_num_to_float(Fou_Num n) {
+    return (float)n / FOU_NUM_ONE;
+}
+
+static inline Fou_Num fou_num_mul(Fou_Num a, Fou_Num b) {
+    return (Fou_Num)(((int64_t)a * b) >> FOU_FIXED_FRAC_BITS);
+}
+
+static inline Fou_Num fou_num_div(Fou_Num a, Fou_Num b) {
+    return (Fou_Num)(((int64_t)a * FOU_NUM_ONE) / b);
+}
+
+#ifndef FOU_COORD_FRAC_BITS
+#define FOU_COORD_FRAC_BITS 6
+#endif
+
+_Static_assert(FOU_COORD_FRAC_BITS < FOU_FIXED_FRAC_BITS, "coordinates are less precise");
+
+/// From -512 up to just below 512, in steps of 1/64 with the default 6
+/// fraction bits.
+typedef int16_t Fou_Coord;
+
+#define FOU_COORD_SHIFT (FOU_FIXED_FRAC_BITS - FOU_COORD_FRAC_BITS)
+
+/// Rounds to the nearest coordinate. Velocities are rounded the same way
+/// before they are added to a coordinate.
+static inline Fou_Coord fou_coord_from_num(Fou_Num n) {
+    return (Fou_Coord)((n + (1 << (FOU_COORD_SHIFT - 1))) >> FOU_COORD_SHIFT);
+}
+
+static inline Fou_Num fou_num_from_coord(Fou_Coord c) {
+    return (Fou_Num)c * (1 << FOU_COORD_SHIFT);
+}
+
+/// Same as fou_num_to_int(fou_num_from_coord(c)).
+static inline int fou_coord_to_int(Fou_Coord c) {
+    return c >> FOU_COORD_FRAC_BITS;
+}
+
+static inline uint32_t fou_isqrt64(uint64_t n) {
+    uint64_t root = 0;
+    uint64_t bit = (uint64_t)1 << 62;
+    while (bit > n) {
+        bit >>= 2;
+    }
+    while (bit != 0) {
+        if (n >= root + bit) {
+            n -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint32_t)root;
+}
+
+/// Length of the vector (x, y). Computed in 64 bits, so it does not overflow
+/// even when the squares would not fit into a Fou_Num.
+static inline Fou_Num fou_num_hypot(Fou_Num x, Fou_Num y) {
+    return (Fou_Num)fou_isqrt64((uint64_t)((int64_t)x * x) + (uint64_t)((int64_t)y * y));
+}
+
+#else
+
+#include <math.h>
+
+typedef float Fou_Num;
+
+#define FOU_NUM_ONE 1.0f
+
+#define FOU_NUM(x) ((Fou_Num)(x))
+
+static inline Fou_Num fou_num_from_int(int i) {
+    return (Fou_Num)i;
+}
+
+static inline Fou_Num fou_num_from_float(float f) {
+    return f;
+}
+
+static inline int fou_num_to_int(Fou_Num n) {
+    return (int)n;
+}
+
+static inline float fou_num_to_float(Fou_Num n) {
+    return n;
+}
+
+static inline Fou_Num fou_num_mul(Fou_Num a, Fou_Num b) {
+    return a * b;
+}
+
+static inline Fou_Num fou_num_div(Fou_Num a, Fou_Num b) {
+    return a / b;
+}
+
+static inline Fou_Num fou_num_hypot(Fou_Num x, Fou_Num y) {
+    return sqrtf(x * x + y * y);
+}
+
+typedef float Fou_Coord;
+
+static inline Fou_Coord fou_coord_from_num(Fou_Num n) {
+    return n;
+}
+
+static inline Fou_Num fou_num_from_coord(Fou_Coord c) {
+    return c;
+}
+
+static inline int fou_coord_to_int(Fou_Coord c) {
+    return (int)c;
+}
+
+#endif
+
+#endif
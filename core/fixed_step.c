@@ -0,0 +1,43 @@
+#include "fixed_step.h"
+
+void fixed_step_init(
+    Fixed_Step* step,
+    uint32_t clock_hz,
+    uint32_t rate,
+    int max_ticks,
+    uint32_t now)
+{
+    *step = (Fixed_Step){
+        .clock_hz = clock_hz,
+        .rate = rate,
+        .max_ticks = max_ticks,
+        .last_clock = now,
+        .accumulated = 0,
+    };
+}
+
+int fixed_step_advance(Fixed_Step* step, uint32_t now) {
+    uint32_t elapsed = now - step->last_clock; // wraps around just fine
+    step->last_clock = now;
+    // a second behind is far more than can be caught up on anyway
+    if (elapsed > step->clock_hz) elapsed = step->clock_hz;
+    step->accumulated += elapsed * step->rate;
+
+    uint32_t due = step->accumulated / step->clock_hz;
+    step->accumulated -= due * step->clock_hz;
+    if (due > (uint32_t)step->max_ticks) {
+        step->ticks_dropped += due - step->max_ticks;
+        due = step->max_ticks;
+    }
+    step->ticks += due;
+    return due;
+}
+
+void fixed_step_resume(Fixed_Step* step, uint32_t now) {
+    step->last_clock = now;
+    step->accumulated = step->clock_hz;
+}
+
+Fou_Num fixed_step_alpha(const Fixed_Step* step) {
+    return fou_num_div(fou_num_from_int(step->accumulated), fou_num_from_int(step->clock_hz));
+}
@@ -0,0 +1,50 @@
+/*
+ * Fixed timestep scheduling of the simulation, independent of how often the
+ * screen is redrawn.
+ *
+ * Whoever drives the game asks how many ticks are due every time it wakes up,
+ * simulates that many and draws the result interpolated by how far into the
+ * next tick it is. Time is counted exactly in units of 1 / `rate` clock
+ * ticks, so rates that do not divide the clock frequency do not drift.
+ */
+
+#ifndef FIXED_STEP_H
+#define FIXED_STEP_H
+
+#include <stdint.h>
+
+#include "fixed.h"
+
+typedef struct {
+    uint32_t clock_hz;
+    uint32_t rate; // simulation ticks per second
+    int max_ticks; // most ticks caught up on at once
+    uint32_t last_clock;
+    uint32_t accumulated; // time not simulated yet, in 1 / rate clock ticks
+    // totals
+    unsigned long ticks;
+    unsigned long ticks_dropped; // backlog beyond max_ticks, never simulated
+} Fixed_Step;
+
+void fixed_step_init(
+    Fixed_Step* step,
+    uint32_t clock_hz,
+    uint32_t rate,
+    int max_ticks,
+    uint32_t now);
+
+/// How many ticks to simulate at clock time `now`. A backlog of more than
+/// `max_ticks` is dropped, the game slows down instead of falling further
+/// behind.
+int fixed_step_advance(Fixed_Step* step, uint32_t now);
+
+/// Start counting time again at clock time `now` after not asking for a
+/// while. Instead of catching up on the time in between, one tick is due right
+/// away.
+void fixed_step_resume(Fixed_Step* step, uint32_t now);
+
+/// How far into the next tick the time passed to fixed_step_advance is, from 0
+/// up to just below 1.
+Fou_Num fixed_step_alpha(const Fixed_Step* step);
+
+#endif
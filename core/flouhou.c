@@ -1,77 +1,176 @@
-#include <math.h>
 #include <stdint.h>
-#include <stdio.h>
 
+#include "broadphase.h"
+#include "fou_math.h"
 #include "pew.h"
 #include "flouhou.h"
+#include "profile.h"
+#include "sprite.h"
+#include "text.h"
 
 #define PLAYER_WIDTH 8
 #define PLAYER_HEIGHT 8
+#define PLAYER_LIFES 3
 #define PLAYER_INVINCIBILITY_FRAMES 32
 #define PLAYER_PEW_WIDTH 8
 #define PLAYER_PEW_HEIGHT 8
 #define PLAYER_DEATH_LENGTH 64
 #define PLAYER_DEATH_DEBRIS_COUNT 5
+#define PLAYER_DEATH_DEBRIS_SIZE 2
+#define PLAYER_DEATH_DEBRIS_SPEED FOU_NUM(1.5)
 
 #define ENEMY_WIDTH 16
 #define ENEMY_HEIGHT 16
 #define ENEMY_HIT_COOLDOWN 16
 #define ENEMY_SHOOT_COOLDOWN 32
-/// controls how quickly the enemy shoots and how quickly the projectiles
-/// become as it takes more hits
-#define ENEMY_COOLDOWN_RETENTION_PER_HIT 0.98
+// how the enemy speeds up as it takes hits is defined in
+// tools/gen_math_tables.py
+
+#define DRONE_RADIUS 4
+#define DRONE_HIT_COOLDOWN 4
+#define DRONE_DEBRIS_COUNT 4
+#define DRONE_DEBRIS_SPEED FOU_NUM(1)
+#define DRONE_DEBRIS_TICKS 12
 
 #define ENEMY_PEW_WIDTH 8
 #define ENEMY_PEW_HEIGHT 8
 
-#define PLAYER_SPEED_RETENTION 0.95
-#define MOVEMENT_SPEED 0.5
+#define PLAYER_SPEED_RETENTION FOU_NUM(0.95)
+#define MOVEMENT_SPEED FOU_NUM(0.5)
+#define PLAYER_PEW_SPEED FOU_NUM(4)
 #define SHOOT_COOLDOWN 8
 
+_Static_assert(
+    PLAYER_LIFES < 1 << 2 && PLAYER_DEATH_LENGTH < 1 << 7 && SHOOT_COOLDOWN < 1 << 4 &&
+        PLAYER_INVINCIBILITY_FRAMES < 1 << 6,
+    "the player's counters overflow their bits in Game_State");
+
+// sparks where a pew hits the enemy
+#define HIT_SPARK_COUNT 3
+#define HIT_SPARK_SPEED FOU_NUM(1.5)
+#define HIT_SPARK_TICKS 6
+// every enemy pew on screen breaks into a burst when the player is hit
+#define CANCEL_BURST_COUNT 2
+#define CANCEL_BURST_SPEED FOU_NUM(0.75)
+#define CANCEL_BURST_TICKS 8
+// particles keep this much of their speed every tick
+#define PARTICLE_DRAG FOU_NUM(0.875)
+
 #define ColorWhite 0
 #define ColorBlack 1
 
-// TODO: Imporve death animation (explosion)
 // TODO: Game over screen that is skippable by input
 
-float map(float src_min, float src_max, float dst_min, float dst_max, float x) {
-    float src_range = src_max - src_min;
-    float dst_range = dst_max - dst_min;
-    return ((x - src_min) / src_range) * dst_range + dst_min;
+/// What sets the kinds of enemies apart, besides their paths and patterns.
+static const struct {
+    uint8_t width;
+    uint8_t height;
+    uint8_t hit_cooldown;
+    uint8_t cooldown_factor; // times the boss' shoot cooldown
+    int8_t mask; // Fou_Icon hits are tested against, -1 for the whole box
+} enemy_kinds[ENEMY_KIND_COUNT] = {
+    [ENEMY_KIND_BOSS] = {ENEMY_WIDTH, ENEMY_HEIGHT, ENEMY_HIT_COOLDOWN, 1, FOU_ICON_BADFILL},
+    // drones are drawn as discs, not icons
+    [ENEMY_KIND_DRONE] = {2 * DRONE_RADIUS, 2 * DRONE_RADIUS, DRONE_HIT_COOLDOWN, 3, -1},
+};
+
+/// Hits the boss has taken, what the difficulty goes by.
+int boss_hits_taken(const Game_State* game_state) {
+    int boss = enemy_index(&game_state->enemies, game_state->boss);
+    return boss < 0 ? 0 : game_state->enemies.hits_taken[boss];
 }
 
-Position calculate_bad_position(float ticks) {
-    // casting ticks from float to double because using floats and sinf will 
-    // eventually cause an 'MPU Fault'. No Idea why.
-    double ticks_double = (double)ticks;
-    float x = sin((double)0.1 * ticks_double);
-    float y = sin((double)0.075982851 * ticks_double);
-    return (Position){
-        .x = map(-1.0, 1.0, 64, 128 - ENEMY_WIDTH, x),
-        .y = map(-1.0, 1.0, 0, 64 - ENEMY_HEIGHT, y),
-    };
+/// The HUD text of the hits taken, formatted again only when they changed.
+const char* hud_hits_text(Fou_Hud_Text* hud_text, const Game_State* game_state) {
+    int hits = boss_hits_taken(game_state);
+    if (hud_text->hits_text[0] == '\0' || hud_text->hits != hits) {
+        hud_text->hits = hits;
+        text_put_int(text_put_str(hud_text->hits_text, FOU_HUD_HITS_PREFIX), hits);
+    }
+    return hud_text->hits_text;
 }
 
-/// Calcutate the the shoot cooldown of the enemy from the amount of hits it
-/// has tacken.
-int hits_to_enemy_shootcooldown(int hits) {
-    return (int)(24 * pow(ENEMY_COOLDOWN_RETENTION_PER_HIT, (double)hits));
+/// Whole pixel hitbox of an object at a sub-pixel position.
+Rect hitbox(Fou_Num x, Fou_Num y, int w, int h) {
+    return (Rect){.x = fou_num_to_int(x), .y = fou_num_to_int(y), .w = w, .h = h};
 }
 
-/// Calculate the speed of enemy pews from the amount of this the enemy has
-/// taken
-float hits_to_enemy_pew_speed(int hits) {
-    return pow(1 / ENEMY_COOLDOWN_RETENTION_PER_HIT, (double)hits);
+/// Whether `icon` drawn at (x, y) touches the enemy of `kind` with `hitbox`,
+/// pixel by pixel.
+static bool touches_enemy(Fou_Icon icon, int x, int y, int kind, Rect hitbox) {
+    int mask = enemy_kinds[kind].mask;
+    if (mask < 0) return fou_sprite_overlaps_rect(icon, x, y, hitbox);
+    return fou_sprites_overlap(icon, x, y, mask, hitbox.x, hitbox.y);
+}
+
+/// Bin the player's pews into `grid` for mark_pews_hitting, again whenever
+/// they were compacted. Builds with PEW_OVERLAP_SCAN never look at it.
+static void bin_pews(Broadphase* grid, const Pews* pews) {
+#if PEW_OVERLAP_SCAN
+    (void)grid;
+    (void)pews;
+#else
+    Rect shot = fou_sprite(FOU_ICON_SHOT)->opaque;
+    broadphase_build(grid, shot.w, shot.h, pews->x, pews->y, pews->len);
+#endif
+}
+
+/// Mark the player's pews that hit the enemy of `kind` with `hitbox`, returns
+/// how many. `grid` is what bin_pews made of them.
+static int mark_pews_hitting(Pews* pews, const Broadphase* grid, int kind, Rect hitbox) {
+    // the box of the pews' pixels first, then the pixels of the few that are
+    // close enough
+    Rect shot = fou_sprite(FOU_ICON_SHOT)->opaque;
+    int x = hitbox.x - shot.x;
+    int y = hitbox.y - shot.y;
+#if PEW_OVERLAP_SCAN
+    (void)grid;
+    int hits = pew_mark_overlapping(pews, shot.w, shot.h, x, y, hitbox.w, hitbox.h);
+#else
+    int hits = broadphase_mark_pews(grid, pews, x, y, hitbox.w, hitbox.h);
+#endif
+    if (hits == 0) return 0;
+    for (int i = 0; i < pews->len; i++) {
+        if (!pew_marked(pews, i)) continue;
+        int x = fou_coord_to_int(pews->x[i]);
+        int y = fou_coord_to_int(pews->y[i]);
+        if (!touches_enemy(FOU_ICON_SHOT, x, y, kind, hitbox)) {
+            pew_unmark(pews, i);
+            hits--;
+        }
+    }
+    return hits;
 }
 
-/// Draw stars
-void draw_stars(int ticks) {
-    fou_draw_dot(-(int)((1.6f * ticks) + 23) % 141 + 128, 13);
-    fou_draw_dot(-(int)((0.5f * ticks) + 2) % 130 + 128, 20);
-    fou_draw_dot(-(int)((1.0f * ticks) + 40) % 129 + 128, 26);
-    fou_draw_dot(-(int)((0.76f * ticks) + 210) % 155 + 128, 46);
-    fou_draw_dot(-(int)((0.45 * ticks) + 428) % 200 + 128, 40);
-    fou_draw_dot(-(int)((1.0 * ticks) + 220) % 152 + 128, 54);
+/// Whether an enemy pew hits the player's ship at (x, y), with `ship` the box
+/// of its pixels.
+static bool player_hit_by_pews(const Enemy_Pews* pews, int x, int y, Rect ship) {
+    Rect pew = fou_sprite(FOU_ICON_BADPEW)->opaque;
+    uint32_t found[POOL_MASK_WORDS(ENEMY_PEW_CAP)];
+    int count = enemypew_find_overlapping(
+        pews, pew.w, pew.h, ship.x - pew.x, ship.y - pew.y, ship.w, ship.h, found);
+    if (count == 0) return false;
+    for (int w = 0; w < POOL_MASK_WORDS(ENEMY_PEW_CAP); w++) {
+        for (uint32_t bits = found[w]; bits != 0; bits &= bits - 1) {
+            int i = w * 32 + __builtin_ctz(bits);
+            int pew_x = fou_coord_to_int(pews->x[i]);
+            int pew_y = fou_coord_to_int(pews->y[i]);
+            if (fou_sprites_overlap(FOU_ICON_BADPEW, pew_x, pew_y, FOU_ICON_SPACESHIP, x, y)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/// Draw stars, `ticks` may be between two ticks.
+void draw_stars(Fou_Render_Target* target, float ticks) {
+    fou_draw_dot(target, -(int)((1.6f * ticks) + 23) % 141 + 128, 13);
+    fou_draw_dot(target, -(int)((0.5f * ticks) + 2) % 130 + 128, 20);
+    fou_draw_dot(target, -(int)((1.0f * ticks) + 40) % 129 + 128, 26);
+    fou_draw_dot(target, -(int)((0.76f * ticks) + 210) % 155 + 128, 46);
+    fou_draw_dot(target, -(int)((0.45f * ticks) + 428) % 200 + 128, 40);
+    fou_draw_dot(target, -(int)((1.0f * ticks) + 220) % 152 + 128, 54);
     // fou_draw_dot(-(int)((8 * 1.6f * ticks) + 23) % 141 + 128, 13);
     // fou_draw_dot(-(int)((8 * 0.5f * ticks) + 2) % 130 + 128, 20);
     // fou_draw_dot(-(int)((8 * 1.0f * ticks) + 40) % 129 + 128, 26);
@@ -80,83 +179,165 @@ void draw_stars(int ticks) {
     // fou_draw_dot(-(int)((8 * 1.0 * ticks) + 220) % 152 + 128, 54);
 }
 
-void draw_outlined_str(uint8_t x, uint8_t y, const char* c_str)  {
-    fou_draw_str(x - 1, y, c_str);
-    fou_draw_str(x + 1, y, c_str);
-    fou_draw_str(x, y - 1, c_str);
-    fou_draw_str(x, y + 1, c_str);
-    fou_invert_color();
-    fou_draw_str(x, y, c_str);
-    fou_invert_color();
+void draw_outlined_str(Fou_Render_Target* target, uint8_t x, uint8_t y, const char* c_str)  {
+    // one call, targets draw the outline from a single copy of the string
+    fou_draw_styled_str(target, x, y, c_str, FOU_STR_OUTLINED);
 }
 
-void draw_outlined_icon(int8_t x, int8_t y, Fou_Icon icon) {
-    fou_invert_color();
-    fou_draw_icon(x - 1, y, icon);
-    fou_draw_icon(x + 1, y, icon);
-    fou_draw_icon(x, y - 1, icon);
-    fou_draw_icon(x, y + 1, icon);
-    fou_invert_color();
-    fou_draw_icon(x, y, icon);
+void draw_outlined_icon(Fou_Render_Target* target, int8_t x, int8_t y, Fou_Icon icon) {
+    // one call, targets draw the outline generated for the sprite
+    fou_draw_outlined_icon(target, x, y, icon);
 }
 
-void draw_enemy(const Game_State* game_state) {
-    Position p = calculate_bad_position(game_state->ticks);
-    uint8_t x = p.x;
-    uint8_t y = p.y;
-    bool invert_color_for_flicker_animation = game_state->enemy.hit_cooldown_ticks_left % 2 == 0;
+void draw_boss(
+    Fou_Render_Target* target,
+    const Game_State* game_state,
+    Position p,
+    int hit_cooldown)
+{
+    uint8_t x = fou_num_to_int(p.x);
+    uint8_t y = fou_num_to_int(p.y);
+    bool invert_color_for_flicker_animation = hit_cooldown % 2 == 0;
     if (invert_color_for_flicker_animation) {
-        fou_invert_color();
+        fou_invert_color(target);
     }
-    fou_draw_icon(x - 1, y, FOU_ICON_BADFILL);
-    fou_draw_icon(x, y + 1, FOU_ICON_BADFILL);
-    fou_draw_icon(x, y - 1, FOU_ICON_BADFILL);
-    fou_draw_icon(x + 1, y, FOU_ICON_BADFILL);
-    fou_invert_color();
+    // the faces are outlined around FOU_ICON_BADFILL, see tools/gen_sprites.py
+    fou_invert_color(target);
     // make enemy laugh when player died
-    if (game_state->player.lifes_left == 0) {
-        fou_draw_icon(x, y, game_state->ticks % 16 > 8 ? FOU_ICON_BADLAUGH0 : FOU_ICON_BADLAUGH1);
+    if (game_state->lifes_left == 0) {
+        fou_draw_outlined_icon(
+            target, x, y, game_state->ticks % 16 > 8 ? FOU_ICON_BADLAUGH0 : FOU_ICON_BADLAUGH1);
     } else {
-        fou_draw_icon(x, y, game_state->ticks % 48 > 24 ? FOU_ICON_BAD0 : FOU_ICON_BAD1);
+        fou_draw_outlined_icon(
+            target, x, y, game_state->ticks % 48 > 24 ? FOU_ICON_BAD0 : FOU_ICON_BAD1);
     }
-    fou_invert_color();
+    fou_invert_color(target);
     if (invert_color_for_flicker_animation) {
-        fou_invert_color();
+        fou_invert_color(target);
     }
 }
 
-void draw_player_death(const Game_State* game_state, int ticks_sice_death) {
-    // draw explosion
-    fou_set_color(ColorWhite);
-    if (ticks_sice_death == 0) {
-        fou_draw_disc(game_state->player.x + 3, game_state->player.y + 4, 8);
-    } else if(ticks_sice_death == 1) {
-        fou_draw_disc(game_state->player.x + 3, game_state->player.y + 4, 12);
-    } else if (ticks_sice_death == 2) {
-        fou_draw_disc(game_state->player.x + 3, game_state->player.y + 4, 14);
-        fou_set_color(ColorBlack);
-        fou_draw_disc(game_state->player.x + 3, game_state->player.y + 4, 8);
-    } else if (ticks_sice_death == 3) {
-        fou_draw_disc(game_state->player.x + 3, game_state->player.y + 4, 15);
-        fou_set_color(ColorBlack);
-        fou_draw_disc(game_state->player.x + 3, game_state->player.y + 4, 13);
-    } else if (ticks_sice_death == 4) {
-        fou_draw_disc(game_state->player.x + 3, game_state->player.y + 4, 16);
-        fou_set_color(ColorBlack);
-        fou_draw_disc(game_state->player.x + 3, game_state->player.y + 4, 15);
+void draw_drone(Fou_Render_Target* target, Position p, int hit_cooldown) {
+    int x = fou_num_to_int(p.x) + DRONE_RADIUS;
+    int y = fou_num_to_int(p.y) + DRONE_RADIUS;
+    fou_set_color(target, ColorWhite);
+    fou_draw_disc(target, x, y, DRONE_RADIUS);
+    fou_set_color(target, ColorBlack);
+    if (hit_cooldown % 2 == 0) {
+        fou_draw_disc(target, x, y, DRONE_RADIUS - 1);
     }
-    fou_set_color(ColorBlack);
+    fou_set_color(target, ColorWhite);
+    fou_draw_dot(target, x, y);
+    fou_set_color(target, ColorBlack);
 }
 
-void draw_pause_screen() {
+static Fou_Num lerp(Fou_Num a, Fou_Num b, Fou_Num alpha) {
+    return a + fou_num_mul(b - a, alpha);
+}
+
+/// Where to draw the enemy at `index`, `behind` ticks before `game_state`. The
+/// enemy is drawn where the last tick moved it to, only the position a tick
+/// before that is evaluated from its path.
+Position enemy_draw_position(const Game_State* game_state, int index, Fou_Num behind) {
+    const Enemies* enemies = &game_state->enemies;
+    Position to = {.x = enemies->x[index], .y = enemies->y[index]};
+    if (behind == 0) return to;
+    // the last tick moved the enemy to its position at age ticks - 1
+    int age = game_state->ticks - 1 - enemies->spawn_tick[index];
+    Position from = enemy_path_position(&enemies->path[index], age - 1);
+    Fou_Num alpha = FOU_NUM_ONE - behind;
+    return (Position){.x = lerp(from.x, to.x, alpha), .y = lerp(from.y, to.y, alpha)};
+}
+
+void draw_enemies(Fou_Render_Target* target, const Game_State* game_state, Fou_Num behind) {
+    const Enemies* enemies = &game_state->enemies;
+    for (int i = 0; i < enemies->len; i++) {
+        Position p = enemy_draw_position(game_state, i, behind);
+        if (enemies->kind[i] == ENEMY_KIND_BOSS) {
+            draw_boss(target, game_state, p, enemies->hit_cooldown[i]);
+        } else {
+            draw_drone(target, p, enemies->hit_cooldown[i]);
+        }
+    }
+}
+
+// The shock wave of the player's explosion, a white disc per tick with a
+// black one cut out of it. The debris is made of particles.
+static const struct {
+    uint8_t outer;
+    uint8_t inner; // 0 for none
+} explosion_rings[] = {{8, 0}, {12, 0}, {14, 8}, {15, 13}, {16, 15}};
+
+void draw_player_death(
+    Fou_Render_Target* target,
+    const Game_State* game_state,
+    int ticks_sice_death)
+{
+    int x = fou_num_to_int(game_state->player.x) + PLAYER_WIDTH / 2 - 1;
+    int y = fou_num_to_int(game_state->player.y) + PLAYER_HEIGHT / 2;
+    int ring_count = sizeof(explosion_rings) / sizeof(explosion_rings[0]);
+    if (ticks_sice_death < ring_count) {
+        fou_set_color(target, ColorWhite);
+        fou_draw_disc(target, x, y, explosion_rings[ticks_sice_death].outer);
+        fou_set_color(target, ColorBlack);
+        if (explosion_rings[ticks_sice_death].inner != 0) {
+            fou_draw_disc(target, x, y, explosion_rings[ticks_sice_death].inner);
+        }
+    }
+    fou_set_color(target, ColorBlack);
+}
+
+void draw_particles(Fou_Render_Target* target, const Particles* particles, Fou_Num behind) {
+    for (int i = 0; i < particles->len; i++) {
+        Particle particle = particle_get(particles, i);
+        int x = fou_num_to_int(particle.x - fou_num_mul(particle.h_speed, behind));
+        int y = fou_num_to_int(particle.y - fou_num_mul(particle.v_speed, behind));
+        if (particle.size == 1) {
+            fou_draw_dot(target, x, y);
+        } else {
+            fou_draw_box(target, x, y, particle.size, particle.size);
+        }
+    }
+}
+
+/// Some angle to start a burst at, so not every burst looks the same.
+static Fou_Angle burst_angle(const Game_State* game_state, int salt) {
+    return (unsigned)(game_state->ticks * 7 + salt * 3) * FOU_ANGLE_DEGREES(23);
+}
+
+/// Break every enemy pew into a burst of particles. With too little room left
+/// in the pool the bursts are thinned evenly over all pews, rather than the
+/// last pews getting none.
+void cancel_enemy_pews(Game_State* game_state) {
+    Enemy_Pews* enemy_pews = &game_state->enemy_pews;
+    int room = PARTICLE_CAP - game_state->particles.len;
+    for (int i = 0; i < enemy_pews->len; i++) {
+        int count = (i + 1) * room / enemy_pews->len - i * room / enemy_pews->len;
+        if (count > CANCEL_BURST_COUNT) count = CANCEL_BURST_COUNT;
+        if (count == 0) continue;
+        particle_burst(
+            &game_state->particles,
+            fou_num_from_coord(enemy_pews->x[i]) + FOU_NUM(ENEMY_PEW_WIDTH / 2),
+            fou_num_from_coord(enemy_pews->y[i]) + FOU_NUM(ENEMY_PEW_HEIGHT / 2),
+            count,
+            CANCEL_BURST_SPEED,
+            burst_angle(game_state, i),
+            CANCEL_BURST_TICKS,
+            1);
+    }
+    enemypew_clear(enemy_pews);
+}
+
+void draw_pause_screen(Fou_Render_Target* target) {
     // fou_draw_box(32, 8, 128 - 2 * 32, 64 - 2 * 8);
-    fou_set_color(ColorWhite);
-    fou_draw_box(24, 14, 128 -  2 * 24, 72 - 2 * 16);
-    fou_set_color(ColorBlack);
-    fou_draw_frame(25, 15, 126 -  2 * 24, 70 - 2 * 16);
-    fou_draw_str(48, 26, "Paused\nBack -> Quit\nShoot -> Resume");
-    fou_draw_str(30, 39, "Back  -> Quit");
-    fou_draw_str(28, 48, "Shoot -> Resume");
+    fou_set_color(target, ColorWhite);
+    fou_draw_box(target, 24, 8, 128 -  2 * 24, 64 - 2 * 8);
+    fou_set_color(target, ColorBlack);
+    fou_draw_frame(target, 25, 9, 126 -  2 * 24, 62 - 2 * 8);
+    fou_draw_static_str(target, 48, 20, "Paused\nBack -> Quit\nShoot -> Resume");
+    fou_draw_static_str(target, 30, 32, "Back  -> Quit");
+    fou_draw_static_str(target, 28, 41, "Shoot -> Resume");
+    fou_draw_static_str(target, 28, 50, "Left  -> Rewind");
 }
 
 bool check_collision(Rect a, Rect b) {
@@ -164,30 +345,39 @@ bool check_collision(Rect a, Rect b) {
 }
 
 Game_State fou_init_game_state() {
-    return (Game_State){
+    Game_State game_state = (Game_State){
         .ticks = 0,
         .pews = {0},
-        .enemy =
-            {.hit_cooldown_ticks_left = 0,
-             .shoot_cooldown_left = hits_to_enemy_shootcooldown(0),
-             .hits_taken = 0},
         .enemy_pews = {0},
+        .particles = {0},
         .player = {
-            .x = 30.0f,
-            .y = 30.0f,
-            .shoot_cooldown_left = 0,
+            .x = FOU_NUM(30),
+            .y = FOU_NUM(30),
             .h_speed = 0,
             .v_speed = 0,
-            .lifes_left = 3,
-            .ticks_since_death = 0,
-            .invincibility_frames_left = 0,
         },
+        .lifes_left = PLAYER_LIFES,
+        .ticks_since_death = 0,
+        .shoot_cooldown_left = 0,
+        .invincibility_frames_left = 0,
         .paused = false,
         .should_quit = false,
     };
+    enemies_init(&game_state.enemies);
+    Enemy_Path boss_path = {
+        .kind = ENEMY_PATH_LOOP,
+        .x = FOU_NUM(64),
+        .y = FOU_NUM(0),
+        .dx = FOU_NUM(64 - ENEMY_WIDTH),
+        .dy = FOU_NUM(64 - ENEMY_HEIGHT),
+    };
+    game_state.boss = enemy_spawn(&game_state.enemies, ENEMY_KIND_BOSS, 0, boss_path, 0);
+    emitter_stage_start(game_state.enemies.emitters[0], 0, fou_hits_to_shoot_cooldown(0));
+    enemy_waves_start(&game_state.waves, 0);
+    return game_state;
 }
 
-void fou_frame(
+void fou_step(
     Game_State* game_state,
     Fou_User_Input_State current_frame_input,
     Fou_User_Input_State prev_frame_input)
@@ -212,218 +402,334 @@ void fou_frame(
         if (current_frame_input.shoot) {
             game_state->paused = false;
         }
-        draw_pause_screen();
         return;
     }
 
+    PROFILE_BEGIN(TICK);
+    PROFILE_BEGIN(INPUT);
     if (current_frame_input.back) {
         game_state->paused = true;
     }
 
     // Change player ship velocity based on input
-    if (game_state->player.lifes_left != 0) {
+    if (game_state->lifes_left != 0) {
         if (current_frame_input.up) game_state->player.v_speed -= MOVEMENT_SPEED;
         if (current_frame_input.down) game_state->player.v_speed += MOVEMENT_SPEED;
         if (current_frame_input.left) game_state->player.h_speed -= MOVEMENT_SPEED;
         if (current_frame_input.right) game_state->player.h_speed += MOVEMENT_SPEED;
         // make player shoot on input
-        if (current_frame_input.shoot && game_state->player.shoot_cooldown_left == 0) {
+        if (current_frame_input.shoot && game_state->shoot_cooldown_left == 0) {
             pew_add(
                 &(game_state->pews), (Pew){.x = game_state->player.x, .y = game_state->player.y});
-            game_state->player.shoot_cooldown_left = SHOOT_COOLDOWN;
+            game_state->shoot_cooldown_left = SHOOT_COOLDOWN;
         }
         //
-        if (game_state->player.shoot_cooldown_left != 0) {
-            game_state->player.shoot_cooldown_left--;
+        if (game_state->shoot_cooldown_left != 0) {
+            game_state->shoot_cooldown_left--;
         }
     }
-    // Bounds checking for player shots
-    for(int i = game_state->pews.len - 1; i >= 0; i--) {
-        game_state->pews.items[i].x += 4;
-        if (game_state->pews.items[i].x > 128) {
-            pew_remove(&game_state->pews, i);
-        }
-    }
-    // Detect collision of projectiles with enemy
-    Position enemy_position = calculate_bad_position(game_state->ticks);
-    if (game_state->enemy.hit_cooldown_ticks_left == 0) {
-        for(int i = game_state->pews.len - 1; i >= 0; i--) {
-            Pew pew = game_state->pews.items[i];
-            if (check_collision(
-                   (Rect){.x = pew.x, .y = pew.y, .w = PLAYER_PEW_WIDTH, .h = PLAYER_PEW_HEIGHT},
-                   (Rect){
-                       .x = enemy_position.x,
-                       .y = enemy_position.y,
-                       .w = ENEMY_WIDTH,
-                       .h = ENEMY_HEIGHT})) {
-                pew_remove(&game_state->pews, i);
-                game_state->enemy.hit_cooldown_ticks_left = ENEMY_HIT_COOLDOWN;
-                game_state->enemy.hits_taken++;
+    PROFILE_END(INPUT);
+
+    PROFILE_BEGIN(PEWS);
+    // move all shots and particles, dropping the ones that left the screen
+    pew_advance(&game_state->pews, PLAYER_PEW_SPEED, FOU_NUM(128));
+    enemypew_advance(
+        &game_state->enemy_pews,
+        ENEMY_PEW_WIDTH,
+        ENEMY_PEW_HEIGHT,
+        128,
+        64,
+        game_state->player.x,
+        game_state->player.y);
+    particle_advance(&game_state->particles, PARTICLE_DRAG, 128, 64);
+    PROFILE_END(PEWS);
+
+    PROFILE_BEGIN(COLLISION);
+    // move every enemy and let it take hits from the player's pews, all in one
+    // pass over the enemies
+    Enemies* enemies = &game_state->enemies;
+    bool player_vulnerable = game_state->lifes_left != 0 &&
+                             game_state->invincibility_frames_left == 0;
+    int player_x = fou_num_to_int(game_state->player.x);
+    int player_y = fou_num_to_int(game_state->player.y);
+    Rect player_hitbox = fou_sprite_hitbox(FOU_ICON_SPACESHIP, player_x, player_y);
+    bool has_been_hit = false;
+    // binned when the first enemy looks for the pews hitting it
+    Broadphase pew_grid;
+    bool pews_binned = false;
+    for (int e = 0; e < enemies->len;) {
+        Position p = enemy_path_position(
+            &enemies->path[e], game_state->ticks - enemies->spawn_tick[e]);
+        enemies->x[e] = p.x;
+        enemies->y[e] = p.y;
+        int kind = enemies->kind[e];
+        Rect enemy_hitbox = hitbox(p.x, p.y, enemy_kinds[kind].width, enemy_kinds[kind].height);
+        bool killed = false;
+        if (enemies->hit_cooldown[e] == 0) {
+            if (!pews_binned) {
+                bin_pews(&pew_grid, &game_state->pews);
+                pews_binned = true;
             }
+            int hits = mark_pews_hitting(&game_state->pews, &pew_grid, kind, enemy_hitbox);
+            if (hits != 0) {
+                for (int i = 0; i < game_state->pews.len; i++) {
+                    if (!pew_marked(&game_state->pews, i)) continue;
+                    particle_burst(
+                        &game_state->particles,
+                        fou_num_from_coord(game_state->pews.x[i]) + FOU_NUM(PLAYER_PEW_WIDTH),
+                        fou_num_from_coord(game_state->pews.y[i]) +
+                            FOU_NUM(PLAYER_PEW_HEIGHT / 2),
+                        HIT_SPARK_COUNT,
+                        HIT_SPARK_SPEED,
+                        burst_angle(game_state, i),
+                        HIT_SPARK_TICKS,
+                        1);
+                }
+                pew_compact(&game_state->pews);
+                pews_binned = false;
+                enemies->hit_cooldown[e] = enemy_kinds[kind].hit_cooldown;
+                enemies->hits_taken[e] += hits;
+                if (enemies->health[e] != 0) {
+                    killed = enemies->health[e] <= hits;
+                    enemies->health[e] -= killed ? enemies->health[e] : hits;
+                }
+            }
+        } else {
+            enemies->hit_cooldown[e]--;
         }
-    } else {
-        game_state->enemy.hit_cooldown_ticks_left--;
-    }
-    // do enemy shots
-    for(int i = game_state->enemy_pews.len - 1; i >= 0; i--) {
-        EnemyPew* epew = &game_state->enemy_pews.items[i];
-        epew->x += epew->h_speed;
-        epew->y += epew->v_speed;
-        Rect enemy_hitbox = {
-            .x = epew->x,
-            .y = epew->y,
-            .w = ENEMY_PEW_WIDTH,
-            .h = ENEMY_PEW_HEIGHT,
-        };
-        Rect screen_hitbox = {
-            .x = 0,
-            .y = 0,
-            .w = 128,
-            .h = 64,
-        };
-        if (!check_collision(enemy_hitbox, screen_hitbox)) {
-            enemypew_remove(&game_state->enemy_pews, i);
+        // check collision with player and enemy
+        if (player_vulnerable && check_collision(player_hitbox, enemy_hitbox) &&
+            touches_enemy(FOU_ICON_SPACESHIP, player_x, player_y, kind, enemy_hitbox)) {
+            has_been_hit = true;
+        }
+        bool left_screen = enemy_hitbox.x + enemy_hitbox.w < 0 || enemy_hitbox.y < -32 ||
+                           enemy_hitbox.y > 64 + 32;
+        if (killed) {
+            particle_burst(
+                &game_state->particles,
+                p.x + fou_num_from_int(enemy_hitbox.w / 2),
+                p.y + fou_num_from_int(enemy_hitbox.h / 2),
+                DRONE_DEBRIS_COUNT,
+                DRONE_DEBRIS_SPEED,
+                burst_angle(game_state, e),
+                DRONE_DEBRIS_TICKS,
+                PLAYER_DEATH_DEBRIS_SIZE);
+        }
+        if (killed || left_screen) {
+            // the last enemy takes its place and is looked at next
+            enemy_retire(enemies, e);
+        } else {
+            e++;
         }
     }
-    if (game_state->player.lifes_left != 0) {
+    if (game_state->lifes_left != 0) {
         // check collision with enemy projectile and player
-        if (game_state->player.invincibility_frames_left == 0) {
-            bool has_been_hit = false;
-            for(int i = 0; i < game_state->enemy_pews.len; i++) {
-                EnemyPew epew = game_state->enemy_pews.items[i];
-                if (check_collision(
-                   (Rect){
-                        .x = game_state->player.x,
-                        .y = game_state->player.y,
-                        .w = PLAYER_WIDTH,
-                        .h = PLAYER_HEIGHT},
-                   (Rect){
-                        .x = epew.x, 
-                        .y = epew.y, 
-                        .w = ENEMY_PEW_WIDTH, 
-                        .h = ENEMY_PEW_HEIGHT})) {
-                    has_been_hit = true;
-                    break;
-                }
-            }
-            // check collision with player and enemy
-            if (!has_been_hit && check_collision(
-                                    (Rect){
-                                        .x = game_state->player.x,
-                                        .y = game_state->player.y,
-                                        .w = PLAYER_WIDTH,
-                                        .h = PLAYER_HEIGHT},
-                                    (Rect){
-                                        .x = enemy_position.x,
-                                        .y = enemy_position.y,
-                                        .w = ENEMY_WIDTH,
-                                        .h = ENEMY_HEIGHT})) {
-                has_been_hit = true;
+        if (game_state->invincibility_frames_left == 0) {
+            if (!has_been_hit) {
+                has_been_hit = player_hit_by_pews(
+                    &game_state->enemy_pews, player_x, player_y, player_hitbox);
             }
             if (has_been_hit) {
-                game_state->player.lifes_left--;
-                game_state->player.invincibility_frames_left = PLAYER_INVINCIBILITY_FRAMES;
+                game_state->lifes_left--;
+                game_state->invincibility_frames_left = PLAYER_INVINCIBILITY_FRAMES;
+                cancel_enemy_pews(game_state);
+                if (game_state->lifes_left == 0) {
+                    particle_burst(
+                        &game_state->particles,
+                        game_state->player.x + FOU_NUM(PLAYER_WIDTH / 2),
+                        game_state->player.y + FOU_NUM(PLAYER_HEIGHT / 2),
+                        PLAYER_DEATH_DEBRIS_COUNT,
+                        PLAYER_DEATH_DEBRIS_SPEED,
+                        burst_angle(game_state, 0),
+                        PLAYER_DEATH_LENGTH / 2,
+                        PLAYER_DEATH_DEBRIS_SIZE);
+                }
             }
         } else {
-            game_state->player.invincibility_frames_left--;
+            game_state->invincibility_frames_left--;
         }
-        // make enemy shoot
-        if (game_state->enemy.shoot_cooldown_left == 0) {
-            game_state->enemy.shoot_cooldown_left =
-                hits_to_enemy_shootcooldown(game_state->enemy.hits_taken);
-            // figure out velocity vector from enemy to player space ship:
-            float h_speed = game_state->player.x - enemy_position.x;
-            float v_speed = game_state->player.y - enemy_position.y;
-            float magnitude = sqrt((double)(h_speed * h_speed + v_speed * v_speed));
-            float speed = hits_to_enemy_pew_speed(game_state->enemy.hits_taken);
-            h_speed = speed * (h_speed / magnitude);
-            v_speed = speed * (v_speed / magnitude);
-            enemypews_add(
-                &game_state->enemy_pews,
-                (EnemyPew){
-                    .x = enemy_position.x,
-                    .y = enemy_position.y,
-                    .h_speed = h_speed,
-                    .v_speed = v_speed,
-                });
-        } else {
-            game_state->enemy.shoot_cooldown_left--;
+        PROFILE_END(COLLISION);
+
+        PROFILE_BEGIN(ENEMY);
+        enemy_waves_tick(&game_state->waves, enemies, game_state->ticks);
+        // make every enemy shoot, the boss switches to denser patterns as it
+        // takes hits and everyone gets faster with it
+        int hits = boss_hits_taken(game_state);
+        int cooldown = fou_hits_to_shoot_cooldown(hits);
+        Emitter_Context emitter_context = {
+            .target_x = game_state->player.x,
+            .target_y = game_state->player.y,
+            .pew_speed = fou_hits_to_pew_speed(hits),
+        };
+        for (int e = 0; e < enemies->len; e++) {
+            if (enemies->kind[e] == ENEMY_KIND_BOSS) {
+                int stage = emitter_stage_for_hits(hits);
+                if (stage != enemies->stage[e]) {
+                    enemies->stage[e] = stage;
+                    emitter_stage_start(enemies->emitters[e], stage, cooldown);
+                }
+            }
+            emitter_context.x = enemies->x[e];
+            emitter_context.y = enemies->y[e];
+            emitter_context.cooldown = cooldown * enemy_kinds[enemies->kind[e]].cooldown_factor;
+            for (int i = 0; i < EMITTERS_PER_ENEMY; i++) {
+                emitter_tick(&enemies->emitters[e][i], &emitter_context, &game_state->enemy_pews);
+            }
         }
+        PROFILE_END(ENEMY);
     } else {
-        if (game_state->player.ticks_since_death == 64) {
+        PROFILE_END(COLLISION);
+        if (game_state->ticks_since_death == PLAYER_DEATH_LENGTH) {
             *game_state = fou_init_game_state();
+            PROFILE_END(TICK);
             return;
         }
-        game_state->player.ticks_since_death++;
+        game_state->ticks_since_death++;
     }
     // apply velocity to player spaceship
     game_state->player.x += game_state->player.h_speed;
     game_state->player.y += game_state->player.v_speed;
-    game_state->player.h_speed *= PLAYER_SPEED_RETENTION;
-    game_state->player.v_speed *= PLAYER_SPEED_RETENTION;
+    game_state->player.h_speed = fou_num_mul(game_state->player.h_speed, PLAYER_SPEED_RETENTION);
+    game_state->player.v_speed = fou_num_mul(game_state->player.v_speed, PLAYER_SPEED_RETENTION);
     // spaceship bounds checking
-    if (game_state->player.y > 64) {
-        game_state->player.y -= 64;
+    if (game_state->player.y > FOU_NUM(64)) {
+        game_state->player.y -= FOU_NUM(64);
     }
     if (game_state->player.y < 0) {
-        game_state->player.y += 64;
+        game_state->player.y += FOU_NUM(64);
     }
     if (game_state->player.x < 0) {
         game_state->player.x = 0;
         game_state->player.h_speed = 0;
     }
-    if (game_state->player.x > 128 - PLAYER_WIDTH /* player_width */) {
+    if (game_state->player.x > FOU_NUM(128 - PLAYER_WIDTH) /* player_width */) {
         game_state->player.h_speed = 0;
-        game_state->player.x = 128 - PLAYER_WIDTH;
+        game_state->player.x = FOU_NUM(128 - PLAYER_WIDTH);
     }
     game_state->ticks++;
+    PROFILE_END(TICK);
+}
+
+void fou_frame(
+    Fou_Render_Target* target,
+    Game_State* game_state,
+    Fou_User_Input_State current_frame_input,
+    Fou_User_Input_State prev_frame_input)
+{
+    bool paused = game_state->paused;
+    fou_step(game_state, current_frame_input, prev_frame_input);
+    if (paused) {
+        draw_pause_screen(target);
+    } else {
+        fou_draw_game(target, game_state);
+    }
+}
+
+/// Where to draw the things that move smoothly, see fou_draw_game_interpolated.
+typedef struct {
+    float ticks;
+    Fou_Num behind; // how many ticks before `game_state` to draw bullets at
+    Fou_Num player_x;
+    Fou_Num player_y;
+    const char* hits_text;
+} Draw_View;
 
-    fou_set_bitmap_mode(true);
-    fou_draw_box(0, 0, 128, 64);
-    fou_invert_color();
-    draw_stars(game_state->ticks);
+static void draw_game(
+    Fou_Render_Target* target,
+    const Game_State* game_state,
+    const Draw_View* view)
+{
+    PROFILE_BEGIN(DRAW);
+    fou_set_bitmap_mode(target, true);
+    fou_draw_box(target, 0, 0, 128, 64);
+    fou_invert_color(target);
+    draw_stars(target, view->ticks);
 
-    // draw shots
+    // draw particles and shots, they are the first thing to go if there are
+    // too many draws
+    fou_set_draw_priority(target, FOU_DRAW_PRIORITY_LOW);
+    draw_particles(target, &game_state->particles, view->behind);
     for(int i = 0; i < game_state->pews.len; i++) {
-        Pew pew = game_state->pews.items[i];
-        draw_outlined_icon(pew.x, pew.y, FOU_ICON_SHOT);
+        Pew pew = pew_get(&game_state->pews, i);
+        pew.x -= fou_num_mul(PLAYER_PEW_SPEED, view->behind);
+        draw_outlined_icon(target, fou_num_to_int(pew.x), fou_num_to_int(pew.y), FOU_ICON_SHOT);
     }
-    fou_invert_color();
+    fou_set_draw_priority(target, FOU_DRAW_PRIORITY_NORMAL);
+    fou_invert_color(target);
     // draw spaceship
-    if (game_state->player.lifes_left != 0) {
-        fou_invert_color();
-        if (game_state->player.invincibility_frames_left % 2 == 0) {
-            draw_outlined_icon(
-                (uint8_t)game_state->player.x,
-                (uint8_t)game_state->player.y,
+    if (game_state->lifes_left != 0) {
+        fou_invert_color(target);
+        if (game_state->invincibility_frames_left % 2 == 0) {
+            draw_outlined_icon(target, 
+                (uint8_t)fou_num_to_int(view->player_x),
+                (uint8_t)fou_num_to_int(view->player_y),
                 FOU_ICON_SPACESHIP);
             // draw space ship twice at screen height offset for seamless transition
             // from bottom to top of screen and vice versa
-            draw_outlined_icon(
-                (uint8_t)game_state->player.x,
-                (uint8_t)game_state->player.y - 64,
+            draw_outlined_icon(target, 
+                (uint8_t)fou_num_to_int(view->player_x),
+                (uint8_t)fou_num_to_int(view->player_y) - 64,
                 FOU_ICON_SPACESHIP);
         }
-        fou_invert_color();
+        fou_invert_color(target);
     } else {
-        draw_player_death(game_state, game_state->player.ticks_since_death);
+        draw_player_death(target, game_state, game_state->ticks_since_death);
     }
-    draw_enemy(game_state);
+    draw_enemies(target, game_state, view->behind);
     // fou_invert_color(canvas);
+    fou_set_draw_priority(target, FOU_DRAW_PRIORITY_LOW);
     for(int i = 0; i < game_state->enemy_pews.len; i++) {
-        EnemyPew epew = game_state->enemy_pews.items[i];
-        draw_outlined_icon(epew.x, epew.y, FOU_ICON_BADPEW);
+        EnemyPew epew = enemypew_get(&game_state->enemy_pews, i);
+        epew.x -= fou_num_mul(epew.h_speed, view->behind);
+        epew.y -= fou_num_mul(epew.v_speed, view->behind);
+        draw_outlined_icon(target, fou_num_to_int(epew.x), fou_num_to_int(epew.y), FOU_ICON_BADPEW);
     }
+    fou_set_draw_priority(target, FOU_DRAW_PRIORITY_NORMAL);
     // display hits
-    char hit_string[32] = {0};
-    snprintf(hit_string, sizeof(hit_string), "hits: %i", game_state->enemy.hits_taken);
-    draw_outlined_str(80, 10, hit_string);
+    draw_outlined_str(target, 80, 10, view->hits_text);
     // display lifes left as hearts
-    fou_invert_color();
-    for(int i = 0; i < game_state->player.lifes_left; i++) {
-        draw_outlined_icon(8 * i + 2, 2, FOU_ICON_HEART);
+    fou_invert_color(target);
+    for(int i = 0; i < game_state->lifes_left; i++) {
+        draw_outlined_icon(target, 8 * i + 2, 2, FOU_ICON_HEART);
     }
-    fou_invert_color();
+    fou_invert_color(target);
+    PROFILE_END(DRAW);
 }
 
+void fou_draw_game(Fou_Render_Target* target, const Game_State* game_state) {
+    Draw_View view = {
+        .ticks = game_state->ticks,
+        .behind = 0,
+        .player_x = game_state->player.x,
+        .player_y = game_state->player.y,
+        .hits_text = hud_hits_text(&target->hud_text, game_state),
+    };
+    draw_game(target, game_state, &view);
+}
 
+void fou_draw_game_interpolated(
+    Fou_Render_Target* target,
+    const Game_State* previous,
+    const Game_State* game_state,
+    Fou_Num alpha)
+{
+    if (previous->ticks + 1 != game_state->ticks) {
+        // not the tick before, after a reset or a rewind
+        fou_draw_game(target, game_state);
+        return;
+    }
+    Fou_Num behind = FOU_NUM_ONE - alpha;
+    Draw_View view = {
+        .ticks = previous->ticks + fou_num_to_float(alpha),
+        .behind = behind,
+        .player_x = lerp(previous->player.x, game_state->player.x, alpha),
+        .player_y = lerp(previous->player.y, game_state->player.y, alpha),
+        .hits_text = hud_hits_text(&target->hud_text, game_state),
+    };
+    Fou_Num dy = game_state->player.y - previous->player.y;
+    if (dy > FOU_NUM(32) || dy < FOU_NUM(-32)) {
+        // wrapped around the screen edge, no point in sliding across it
+        view.player_y = game_state->player.y;
+    }
+    draw_game(target, game_state, &view);
+}
@@ -1,15 +1,24 @@
 /*
- * Set of functions that need to be implemented.
+ * The game: the state of a run, the simulation stepping it and the drawing of
+ * it through a render target.
+ *
+ * Nothing in here keeps state of its own. Any number of Game_States can be
+ * stepped at once, on as many threads, as long as each has its own render
+ * target or is only ever stepped with fou_step.
  */
 
+#ifndef FLOUHOU_H
+#define FLOUHOU_H
+
 #include <stdbool.h>
+#include <stddef.h>
 
+#include "emitter.h"
+#include "enemy.h"
+#include "fixed.h"
+#include "particle.h"
 #include "pew.h"
-
-typedef struct {
-    float x;
-    float y;
-} Position;
+#include "text.h"
 
 typedef struct {
     int x;
@@ -19,32 +28,49 @@ typedef struct {
 } Rect;
 
 typedef struct {
-    int lifes_left;
-    int ticks_since_death;
-    float x;
-    float y;
-    float h_speed;
-    float v_speed;
-    int shoot_cooldown_left;
-    int invincibility_frames_left; // == 0 means player is vincible
+    Fou_Num x;
+    Fou_Num y;
+    Fou_Num h_speed;
+    Fou_Num v_speed;
 } Player;
 
-typedef struct { // position of enemy is a function of time, so it's not stored.
-    int hit_cooldown_ticks_left; // the amount of ticks the enemy is invisible after being hit
-    int shoot_cooldown_left;
-    int hits_taken;
-} Enemy;
-
+/// Everything a tick reads and writes comes first, in the order a tick goes
+/// through it, then the particles, which are only drawn, then what changes
+/// rarely. The parts have byte budgets, see GAME_STATE_HOT_BUDGET.
 typedef struct {
     int ticks;
+    Player player;
     Pews pews;
     Enemy_Pews enemy_pews;
-    Player player;
-    Enemy enemy;
-    bool paused;
-    bool should_quit; // Communicate to event loop that the game should close
+    Enemies enemies;
+    Enemy_Handle boss; // the enemy whose hits count, see fou_hits_to_shoot_cooldown
+    Enemy_Waves waves;
+    Particles particles;
+    // cold, the player's counters and the flags bit-packed into one word, each
+    // counter as wide as its largest value needs
+    unsigned lifes_left : 2;
+    unsigned ticks_since_death : 7;
+    unsigned shoot_cooldown_left : 4;
+    unsigned invincibility_frames_left : 6; // == 0 means player is vincible
+    bool paused : 1;
+    bool should_quit : 1; // Communicate to event loop that the game should close
 } Game_State;
 
+#if FOU_FIXED_POINT
+/// Bytes the device build may spend on the hot part of a Game_State, from
+/// `ticks` up to the particles, and on all of it: a little for the pools'
+/// lengths, the player and the waves, then so much per pooled item. A field
+/// added to a hot item has to fit in here or change them on purpose.
+/// host/fou_bench prints what each part takes.
+#define GAME_STATE_HOT_BUDGET (96 + PEW_CAP * 4 + ENEMY_PEW_CAP * 18 + ENEMY_CAP * 80)
+#define GAME_STATE_BUDGET (GAME_STATE_HOT_BUDGET + PARTICLE_CAP * 14 + 16)
+
+_Static_assert(
+    offsetof(Game_State, particles) <= GAME_STATE_HOT_BUDGET,
+    "the hot part of Game_State is over budget");
+_Static_assert(sizeof(Game_State) <= GAME_STATE_BUDGET, "Game_State is over budget");
+#endif
+
 // typedef struct {
 //     GameState game_state;
 //     FuriMessageQueue* queue;
@@ -71,23 +97,158 @@ typedef enum {
     FOU_ICON_HEART,
 } Fou_Icon;
 
+typedef enum {
+    FOU_DRAW_PRIORITY_NORMAL,
+    FOU_DRAW_PRIORITY_LOW, // may be dropped first when a frame gets too busy
+} Fou_Draw_Priority;
+
+/// How a string is drawn, or'ed together.
+typedef enum {
+    FOU_STR_PLAIN = 0,
+    /// The string never changes and outlives every frame, like a literal.
+    /// Targets keep the pointer instead of copying it.
+    FOU_STR_STATIC = 1 << 0,
+    /// Drawn in the inverted color, inside a one pixel outline in the current
+    /// color.
+    FOU_STR_OUTLINED = 1 << 1,
+} Fou_Str_Flags;
+
+/// What a render target implements, every function gets the target's
+/// `context` first.
+typedef struct {
+    void (*draw_box)(void* context, int x, int y, int width, int height);
+    void (*draw_disc)(void* context, int x, int y, int radius);
+    void (*draw_dot)(void* context, int x, int y);
+    void (*draw_frame)(void* context, int x, int y, int width, int height);
+    void (*draw_icon)(void* context, int x, int y, Fou_Icon icon);
+    /// `icon` inside a one pixel outline in the inverted color. Draws the same
+    /// as inverting the color, drawing the icon it is outlined by one pixel to
+    /// the left, right, top and bottom, inverting back and drawing `icon`,
+    /// see Fou_Sprite.
+    void (*draw_outlined_icon)(void* context, int x, int y, Fou_Icon icon);
+    void (*draw_str)(void* context, int x, int y, const char* string, Fou_Str_Flags flags);
+    void (*invert_color)(void* context);
+    void (*set_bitmap_mode)(void* context, bool alpha);
+    void (*set_color)(void* context, bool color);
+    /// Applies to the draws that follow, until the end of the frame.
+    void (*set_draw_priority)(void* context, Fou_Draw_Priority priority);
+} Fou_Render_Functions;
+
+#define FOU_HUD_HITS_PREFIX "hits: "
+
+/// Strings of the HUD. They are formatted again only when what they show
+/// changes, not every frame.
+typedef struct {
+    int hits; // what `hits_text` shows, if it is not empty
+    char hits_text[sizeof(FOU_HUD_HITS_PREFIX) - 1 + TEXT_INT_MAX_CHARS + 1];
+} Fou_Hud_Text;
+
+/// Where a frame is drawn to, see draw_list_render_target and
+/// raster_render_target. Drawing never writes to a Game_State, what it caches
+/// between frames stays with the target. Keep one target around for as long
+/// as it draws the same game.
+typedef struct {
+    const Fou_Render_Functions* functions;
+    void* context;
+    Fou_Hud_Text hud_text; // empty in a new target
+} Fou_Render_Target;
+
+/// Simulate one tick of `game_state`, drawing nothing.
+void fou_step(
+    Game_State* game_state,
+    Fou_User_Input_State current_frame,
+    Fou_User_Input_State prev_frame);
+
+/// fou_step, then draw the result to `target`: the game or, if it was paused
+/// during the tick, the pause screen.
 void fou_frame(
+    Fou_Render_Target* target,
     Game_State* game_state,
     Fou_User_Input_State current_frame,
-    Fou_User_Input_State prev_frame
-);
+    Fou_User_Input_State prev_frame);
 
 Game_State fou_init_game_state();
 
-// external functions that need to be implementd:
+/// Draw `game_state` the way fou_frame draws it after a tick, without
+/// simulating anything.
+void fou_draw_game(Fou_Render_Target* target, const Game_State* game_state);
+
+/// Draw the game between `previous` and the tick after it, `game_state`. Alpha
+/// runs from 0 at `previous` to 1 at `game_state`. Bullets are moved back
+/// along their velocity, since their slots do not line up between two ticks.
+void fou_draw_game_interpolated(
+    Fou_Render_Target* target,
+    const Game_State* previous,
+    const Game_State* game_state,
+    Fou_Num alpha);
+
+static inline void fou_draw_box(Fou_Render_Target* target, int x, int y, int width, int height) {
+    target->functions->draw_box(target->context, x, y, width, height);
+}
+
+static inline void fou_draw_disc(Fou_Render_Target* target, int x, int y, int radius) {
+    target->functions->draw_disc(target->context, x, y, radius);
+}
+
+static inline void fou_draw_dot(Fou_Render_Target* target, int x, int y) {
+    target->functions->draw_dot(target->context, x, y);
+}
+
+static inline void fou_draw_frame(Fou_Render_Target* target, int x, int y, int width, int height) {
+    target->functions->draw_frame(target->context, x, y, width, height);
+}
+
+static inline void fou_draw_icon(Fou_Render_Target* target, int x, int y, Fou_Icon icon) {
+    target->functions->draw_icon(target->context, x, y, icon);
+}
+
+static inline void fou_draw_outlined_icon(
+    Fou_Render_Target* target,
+    int x,
+    int y,
+    Fou_Icon icon)
+{
+    target->functions->draw_outlined_icon(target->context, x, y, icon);
+}
+
+static inline void fou_draw_styled_str(
+    Fou_Render_Target* target,
+    int x,
+    int y,
+    const char* string,
+    Fou_Str_Flags flags)
+{
+    target->functions->draw_str(target->context, x, y, string, flags);
+}
+
+static inline void fou_draw_str(Fou_Render_Target* target, int x, int y, const char* string) {
+    fou_draw_styled_str(target, x, y, string, FOU_STR_PLAIN);
+}
+
+/// fou_draw_str of a string literal, see FOU_STR_STATIC.
+static inline void fou_draw_static_str(
+    Fou_Render_Target* target,
+    int x,
+    int y,
+    const char* string)
+{
+    fou_draw_styled_str(target, x, y, string, FOU_STR_STATIC);
+}
+
+static inline void fou_invert_color(Fou_Render_Target* target) {
+    target->functions->invert_color(target->context);
+}
+
+static inline void fou_set_bitmap_mode(Fou_Render_Target* target, bool alpha) {
+    target->functions->set_bitmap_mode(target->context, alpha);
+}
+
+static inline void fou_set_color(Fou_Render_Target* target, bool color) {
+    target->functions->set_color(target->context, color);
+}
 
-void fou_draw_box(int x, int y, int width, int height);
-void fou_draw_disc(int x, int y, int radius);
-void fou_draw_dot(int x, int y);
-void fou_draw_frame(int x, int y, int width, int height);
-void fou_draw_icon(int x, int y, Fou_Icon icon);
-void fou_draw_str(int x, int y, const char* string);
-void fou_invert_color();
-void fou_set_bitmap_mode(bool alpha);
-void fou_set_color(bool color);
+static inline void fou_set_draw_priority(Fou_Render_Target* target, Fou_Draw_Priority priority) {
+    target->functions->set_draw_priority(target->context, priority);
+}
 
+#endif
@@ -0,0 +1,89 @@
+#include "fou_math.h"
+#include "math_tables.h"
+
+/// Convert a table value with `frac_bits` fractional bits to Fou_Num.
+static Fou_Num from_table_fixed(int32_t value, int frac_bits) {
+#if FOU_FIXED_POINT
+    if (FOU_FIXED_FRAC_BITS >= frac_bits) {
+        return value * (1 << (FOU_FIXED_FRAC_BITS - frac_bits));
+    }
+    return value >> (frac_bits - FOU_FIXED_FRAC_BITS);
+#else
+    return (float)value / (float)(1 << frac_bits);
+#endif
+}
+
+Fou_Num fou_sin(Fou_Angle angle) {
+    int index = angle >> (16 - SINE_TABLE_BITS);
+    int frac = angle & ((1 << (16 - SINE_TABLE_BITS)) - 1);
+    int32_t a = sine_table[index];
+    int32_t b = sine_table[index + 1];
+    return from_table_fixed(a + (((b - a) * frac) >> (16 - SINE_TABLE_BITS)), 14);
+}
+
+Fou_Num fou_cos(Fou_Angle angle) {
+    return fou_sin((Fou_Angle)(angle + 0x4000));
+}
+
+void fou_enemy_path(int ticks, Fou_Num* x, Fou_Num* y) {
+    // the phase wraps around exactly once per turn, so it stays precise no
+    // matter how long the game runs
+    uint32_t phase_x = (uint32_t)ticks * ENEMY_PATH_X_PHASE_STEP;
+    uint32_t phase_y = (uint32_t)ticks * ENEMY_PATH_Y_PHASE_STEP;
+    *x = fou_sin((Fou_Angle)(phase_x >> 16));
+    *y = fou_sin((Fou_Angle)(phase_y >> 16));
+}
+
+static int clamp_hits(int hits) {
+    if (hits < 0) return 0;
+    if (hits > ENEMY_MAX_SCALED_HITS) return ENEMY_MAX_SCALED_HITS;
+    return hits;
+}
+
+int fou_hits_to_shoot_cooldown(int hits) {
+    return hits_to_shoot_cooldown_table[clamp_hits(hits)];
+}
+
+Fou_Num fou_hits_to_pew_speed(int hits) {
+    return from_table_fixed(hits_to_pew_speed_table[clamp_hits(hits)], 16);
+}
+
+#if FOU_FIXED_POINT
+
+void fou_vector_set_length(Fou_Num* x, Fou_Num* y, Fou_Num length) {
+    Fou_Num magnitude = fou_num_hypot(*x, *y);
+    if (magnitude == 0) {
+        return;
+    }
+    // one division instead of one per component
+    Fou_Num scale = fou_num_div(length, magnitude);
+    *x = fou_num_mul(*x, scale);
+    *y = fou_num_mul(*y, scale);
+}
+
+#else
+
+/// Single precision 1 / sqrt(x) from the classic bit level estimate refined by
+/// two Newton steps, accurate to about 5e-6.
+static float rsqrt(float x) {
+    union {
+        float f;
+        uint32_t i;
+    } u = {.f = x};
+    u.i = 0x5f375a86u - (u.i >> 1);
+    u.f *= 1.5f - 0.5f * x * u.f * u.f;
+    u.f *= 1.5f - 0.5f * x * u.f * u.f;
+    return u.f;
+}
+
+void fou_vector_set_length(Fou_Num* x, Fou_Num* y, Fou_Num length) {
+    float squared = *x * *x + *y * *y;
+    if (squared == 0) {
+        return;
+    }
+    float scale = length * rsqrt(squared);
+    *x *= scale;
+    *y *= scale;
+}
+
+#endif
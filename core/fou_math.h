@@ -0,0 +1,35 @@
+/*
+ * Table driven replacements for the libm functions the game used to call
+ * every tick. See tools/gen_math_tables.py for where the tables come from.
+ */
+
+#ifndef FOU_MATH_H
+#define FOU_MATH_H
+
+#include <stdint.h>
+
+#include "fixed.h"
+
+/// Angle as a fraction of a full turn, 0x10000 would be 360 degrees.
+typedef uint16_t Fou_Angle;
+
+#define FOU_ANGLE_DEGREES(d) ((Fou_Angle)((d) * 65536.0 / 360.0 + 0.5))
+
+Fou_Num fou_sin(Fou_Angle angle);
+
+Fou_Num fou_cos(Fou_Angle angle);
+
+/// Enemy trajectory at `ticks`, both coordinates in the range [-1, 1].
+void fou_enemy_path(int ticks, Fou_Num* x, Fou_Num* y);
+
+/// Enemy shoot cooldown in ticks after it has taken `hits` hits.
+int fou_hits_to_shoot_cooldown(int hits);
+
+/// Speed of enemy pews in pixels per tick after the enemy has taken `hits`
+/// hits.
+Fou_Num fou_hits_to_pew_speed(int hits);
+
+/// Scale the vector (x, y) to `length`. A zero vector is left untouched.
+void fou_vector_set_length(Fou_Num* x, Fou_Num* y, Fou_Num length);
+
+#endif
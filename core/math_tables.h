@@ -0,0 +1,110 @@
+/*
+ * Generated by tools/gen_math_tables.py, do not edit.
+ */
+
+#ifndef MATH_TABLES_H
+#define MATH_TABLES_H
+
+#include <stdint.h>
+
+#define SINE_TABLE_BITS 8
+
+#define ENEMY_PATH_X_PHASE_STEP 68356528u
+#define ENEMY_PATH_Y_PHASE_STEP 51939238u
+
+#define ENEMY_MAX_SCALED_HITS 255
+
+/// sin over one full turn in Q2.14, so that 1 and -1 are exact
+static const int16_t sine_table[257] = {
+    0, 402, 804, 1205, 1606, 2006, 2404, 2801,
+    3196, 3590, 3981, 4370, 4756, 5139, 5520, 5897,
+    6270, 6639, 7005, 7366, 7723, 8076, 8423, 8765,
+    9102, 9434, 9760, 10080, 10394, 10702, 11003, 11297,
+    11585, 11866, 12140, 12406, 12665, 12916, 13160, 13395,
+    13623, 13842, 14053, 14256, 14449, 14635, 14811, 14978,
+    15137, 15286, 15426, 15557, 15679, 15791, 15893, 15986,
+    16069, 16143, 16207, 16261, 16305, 16340, 16364, 16379,
+    16384, 16379, 16364, 16340, 16305, 16261, 16207, 16143,
+    16069, 15986, 15893, 15791, 15679, 15557, 15426, 15286,
+    15137, 14978, 14811, 14635, 14449, 14256, 14053, 13842,
+    13623, 13395, 13160, 12916, 12665, 12406, 12140, 11866,
+    11585, 11297, 11003, 10702, 10394, 10080, 9760, 9434,
+    9102, 8765, 8423, 8076, 7723, 7366, 7005, 6639,
+    6270, 5897, 5520, 5139, 4756, 4370, 3981, 3590,
+    3196, 2801, 2404, 2006, 1606, 1205, 804, 402,
+    0, -402, -804, -1205, -1606, -2006, -2404, -2801,
+    -3196, -3590, -3981, -4370, -4756, -5139, -5520, -5897,
+    -6270, -6639, -7005, -7366, -7723, -8076, -8423, -8765,
+    -9102, -9434, -9760, -10080, -10394, -10702, -11003, -11297,
+    -11585, -11866, -12140, -12406, -12665, -12916, -13160, -13395,
+    -13623, -13842, -14053, -14256, -14449, -14635, -14811, -14978,
+    -15137, -15286, -15426, -15557, -15679, -15791, -15893, -15986,
+    -16069, -16143, -16207, -16261, -16305, -16340, -16364, -16379,
+    -16384, -16379, -16364, -16340, -16305, -16261, -16207, -16143,
+    -16069, -15986, -15893, -15791, -15679, -15557, -15426, -15286,
+    -15137, -14978, -14811, -14635, -14449, -14256, -14053, -13842,
+    -13623, -13395, -13160, -12916, -12665, -12406, -12140, -11866,
+    -11585, -11297, -11003, -10702, -10394, -10080, -9760, -9434,
+    -9102, -8765, -8423, -8076, -7723, -7366, -7005, -6639,
+    -6270, -5897, -5520, -5139, -4756, -4370, -3981, -3590,
+    -3196, -2801, -2404, -2006, -1606, -1205, -804, -402,
+    0,
+};
+
+/// enemy shoot cooldown in ticks by hits taken
+static const uint8_t hits_to_shoot_cooldown_table[256] = {
+    24, 23, 23, 22, 22, 21, 21, 20, 20, 20, 19, 19, 18, 18, 18, 17,
+    17, 17, 16, 16, 16, 15, 15, 15, 14, 14, 14, 13, 13, 13, 13, 12,
+    12, 12, 12, 11, 11, 11, 11, 10, 10, 10, 10, 10, 9, 9, 9, 9,
+    9, 8, 8, 8, 8, 8, 8, 7, 7, 7, 7, 7, 7, 6, 6, 6,
+    6, 6, 6, 6, 6, 5, 5, 5, 5, 5, 5, 5, 5, 5, 4, 4,
+    4, 4, 4, 4, 4, 4, 4, 4, 4, 3, 3, 3, 3, 3, 3, 3,
+    3, 3, 3, 3, 3, 3, 3, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+};
+
+/// enemy pew speed in Q15.16 pixels per tick by hits taken
+static const int32_t hits_to_pew_speed_table[256] = {
+    65536, 66873, 68238, 69631, 71052, 72502, 73982, 75491,
+    77032, 78604, 80208, 81845, 83515, 85220, 86959, 88734,
+    90545, 92392, 94278, 96202, 98165, 100169, 102213, 104299,
+    106428, 108600, 110816, 113077, 115385, 117740, 120143, 122595,
+    125097, 127650, 130255, 132913, 135625, 138393, 141218, 144100,
+    147040, 150041, 153103, 156228, 159416, 162670, 165989, 169377,
+    172834, 176361, 179960, 183633, 187380, 191204, 195107, 199088,
+    203151, 207297, 211528, 215845, 220250, 224745, 229331, 234011,
+    238787, 243660, 248633, 253707, 258885, 264168, 269559, 275061,
+    280674, 286402, 292247, 298211, 304297, 310508, 316844, 323311,
+    329909, 336642, 343512, 350522, 357676, 364975, 372424, 380024,
+    387780, 395694, 403769, 412009, 420418, 428998, 437753, 446686,
+    455802, 465105, 474596, 484282, 494165, 504250, 514541, 525042,
+    535757, 546691, 557848, 569233, 580850, 592704, 604800, 617143,
+    629737, 642589, 655703, 669085, 682740, 696673, 710891, 725399,
+    740203, 755309, 770724, 786453, 802503, 818880, 835592, 852645,
+    870046, 887802, 905921, 924409, 943274, 962525, 982168, 1002212,
+    1022666, 1043536, 1064833, 1086564, 1108739, 1131366, 1154455, 1178016,
+    1202057, 1226589, 1251621, 1277164, 1303229, 1329825, 1356965, 1384658,
+    1412916, 1441751, 1471175, 1501199, 1531835, 1563097, 1594997, 1627548,
+    1660764, 1694657, 1729242, 1764532, 1800543, 1837289, 1874785, 1913045,
+    1952087, 1991926, 2032577, 2074058, 2116386, 2159578, 2203651, 2248623,
+    2294513, 2341340, 2389123, 2437880, 2487633, 2538401, 2590205, 2643066,
+    2697007, 2752048, 2808212, 2865522, 2924002, 2983676, 3044567, 3106701,
+    3170103, 3234799, 3300815, 3368179, 3436917, 3507059, 3578631, 3651664,
+    3726188, 3802233, 3879829, 3959010, 4039806, 4122251, 4206378, 4292223,
+    4379819, 4469203, 4560412, 4653481, 4748450, 4845357, 4944242, 5045145,
+    5148107, 5253171, 5360378, 5469774, 5581402, 5695308, 5811539, 5930141,
+    6051165, 6174658, 6300671, 6429256, 6560466, 6694353, 6830972, 6970380,
+    7112633, 7257788, 7405906, 7557047, 7711273, 7868646, 8029230, 8193092,
+    8360298, 8530916, 8705017, 8882670, 9063949, 9248928, 9437681, 9630287,
+    9826824, 10027371, 10232011, 10440828, 10653906, 10871333, 11093196, 11319588,
+};
+
+#endif
@@ -0,0 +1,85 @@
+#include "particle.h"
+#include "pool.h"
+
+bool particle_add(Particles* particles, Particle particle) {
+    if (particles->len == PARTICLE_CAP) {
+        particles->dropped++;
+        return false;
+    }
+    int i = particles->len++;
+    particles->x[i] = fou_coord_from_num(particle.x);
+    particles->y[i] = fou_coord_from_num(particle.y);
+    particles->h_speed[i] = particle.h_speed;
+    particles->v_speed[i] = particle.v_speed;
+    particles->ticks_left[i] = particle.ticks_left;
+    particles->size[i] = particle.size;
+    return true;
+}
+
+void particle_burst(
+    Particles* particles,
+    Fou_Num x,
+    Fou_Num y,
+    int count,
+    Fou_Num speed,
+    Fou_Angle angle,
+    int ticks,
+    int size)
+{
+    Fou_Angle step = 0x10000 / count;
+    for (int i = 0; i < count; i++) {
+        Fou_Angle a = angle + i * step;
+        particle_add(
+            particles,
+            (Particle){
+                .x = x,
+                .y = y,
+                .h_speed = fou_num_mul(speed, fou_cos(a)),
+                .v_speed = fou_num_mul(speed, fou_sin(a)),
+                .ticks_left = ticks,
+                .size = size,
+            });
+    }
+}
+
+void particle_advance(Particles* particles, Fou_Num drag, int screen_w, int screen_h) {
+    int len = particles->len;
+    // field by field, every loop only touches one or two arrays
+    for (int i = 0; i < len; i++) {
+        particles->x[i] += fou_coord_from_num(particles->h_speed[i]);
+    }
+    for (int i = 0; i < len; i++) {
+        particles->y[i] += fou_coord_from_num(particles->v_speed[i]);
+    }
+    for (int i = 0; i < len; i++) {
+        particles->h_speed[i] = fou_num_mul(particles->h_speed[i], drag);
+    }
+    for (int i = 0; i < len; i++) {
+        particles->v_speed[i] = fou_num_mul(particles->v_speed[i], drag);
+    }
+    for (int i = 0; i < len; i++) {
+        particles->ticks_left[i]--;
+    }
+
+    Pool_Field fields[] = {
+        POOL_FIELD(particles->x),
+        POOL_FIELD(particles->y),
+        POOL_FIELD(particles->h_speed),
+        POOL_FIELD(particles->v_speed),
+        POOL_FIELD(particles->ticks_left),
+        POOL_FIELD(particles->size),
+    };
+    for (int i = 0; i < len;) {
+        int x = fou_coord_to_int(particles->x[i]);
+        int y = fou_coord_to_int(particles->y[i]);
+        int size = particles->size[i];
+        bool on_screen = x + size > 0 && x < screen_w && y + size > 0 && y < screen_h;
+        if (particles->ticks_left[i] != 0 && on_screen) {
+            i++;
+            continue;
+        }
+        // the last particle takes its slot, and is looked at next
+        pool_move_slot(fields, POOL_FIELD_COUNT(fields), --len, i);
+    }
+    particles->len = len;
+}
@@ -0,0 +1,81 @@
+/*
+ * Short lived effects: debris of the player's ship, sparks where pews hit the
+ * enemy and the bursts cancelled enemy pews break into.
+ *
+ * Particles are part of the Game_State and replay with everything else, but
+ * nothing in the simulation reads them, so rewind snapshots leave them out.
+ * They are stored like the bullets of pew.h, one array per field with the
+ * particles in slots [0, len) and positions as 16 bit Fou_Coords, and adding
+ * to a full pool counts the particle as dropped. A tick updates all of them
+ * field by field in plain loops over the arrays. The order of particles does
+ * not matter, expired ones are replaced by the last one instead of moving
+ * everything after them.
+ */
+
+#ifndef PARTICLE_H
+#define PARTICLE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "fixed.h"
+#include "fou_math.h"
+
+// Room for every enemy pew of a full pool breaking into a cancel burst of two
+// at once, with as many again for the sparks and debris around it.
+#ifndef PARTICLE_CAP
+#define PARTICLE_CAP 128
+#endif
+
+/// One particle, for adding and reading.
+typedef struct {
+    Fou_Num x;
+    Fou_Num y;
+    Fou_Num h_speed;
+    Fou_Num v_speed;
+    uint8_t ticks_left; // drawn for this many more ticks
+    uint8_t size; // drawn as a size x size box
+} Particle;
+
+typedef struct {
+    int len;
+    int dropped; // amount of particles that did not fit
+    Fou_Coord x[PARTICLE_CAP];
+    Fou_Coord y[PARTICLE_CAP];
+    Fou_Num h_speed[PARTICLE_CAP];
+    Fou_Num v_speed[PARTICLE_CAP];
+    uint8_t ticks_left[PARTICLE_CAP];
+    uint8_t size[PARTICLE_CAP];
+} Particles;
+
+/// Returns false and counts the particle as dropped if `particles` is full.
+bool particle_add(Particles* particles, Particle particle);
+
+static inline Particle particle_get(const Particles* particles, int index) {
+    return (Particle){
+        .x = fou_num_from_coord(particles->x[index]),
+        .y = fou_num_from_coord(particles->y[index]),
+        .h_speed = particles->h_speed[index],
+        .v_speed = particles->v_speed[index],
+        .ticks_left = particles->ticks_left[index],
+        .size = particles->size[index],
+    };
+}
+
+/// Add `count` particles at (x, y) flying apart at `speed`, evenly spaced
+/// around a circle starting at `angle`.
+void particle_burst(
+    Particles* particles,
+    Fou_Num x,
+    Fou_Num y,
+    int count,
+    Fou_Num speed,
+    Fou_Angle angle,
+    int ticks,
+    int size);
+
+/// Move every particle by its speed and multiply the speed by `drag`. Removes
+/// the particles that expired or left the screen_w x screen_h screen.
+void particle_advance(Particles* particles, Fou_Num drag, int screen_w, int screen_h);
+
+#endif
@@ -1,33 +1,606 @@
 #include "pew.h"
+#include "fou_math.h"
 #include <core/check.h>
 
-void pew_add(Pews* pews, const Pew pew) {
-    furi_assert(pews->len == PEW_CAP, "cannot add to full pews");
-    pews->items[pews->len++] = pew;
+// Four 32 bit lanes for Fou_Nums and eight 16 bit lanes for Fou_Coords,
+// whatever the instruction set. Comparisons set the top bit of the lanes where
+// they hold and clear it in the others, that bit is all coord_lanes_and and
+// coord_lanes_bits look at.
+#define LANES 4
+#define COORD_LANES 8
+
+#if PEW_SIMD == PEW_SIMD_SSE2
+
+#include <emmintrin.h>
+
+typedef __m128i Lanes;
+
+static inline Lanes lanes_load(const Fou_Num* p) {
+    return _mm_loadu_si128((const __m128i*)p);
+}
+
+typedef __m128i Coord_Lanes;
+
+static inline Coord_Lanes coord_lanes_load(const Fou_Coord* p) {
+    return _mm_loadu_si128((const __m128i*)p);
+}
+
+static inline void coord_lanes_store(Fou_Coord* p, Coord_Lanes v) {
+    _mm_storeu_si128((__m128i*)p, v);
+}
+
+static inline Coord_Lanes coord_lanes_splat(int16_t value) {
+    return _mm_set1_epi16(value);
+}
+
+static inline Coord_Lanes coord_lanes_add(Coord_Lanes a, Coord_Lanes b) {
+    return _mm_add_epi16(a, b);
+}
+
+/// fou_coord_from_num of the lanes of `low`, then those of `high`.
+static inline Coord_Lanes coord_lanes_from_num(Lanes low, Lanes high) {
+    Lanes half = _mm_set1_epi32(1 << (FOU_COORD_SHIFT - 1));
+    return _mm_packs_epi32(
+        _mm_srai_epi32(_mm_add_epi32(low, half), FOU_COORD_SHIFT),
+        _mm_srai_epi32(_mm_add_epi32(high, half), FOU_COORD_SHIFT));
+}
+
+/// fou_coord_to_int of every lane.
+static inline Coord_Lanes coord_lanes_to_int(Coord_Lanes a) {
+    return _mm_srai_epi16(a, FOU_COORD_FRAC_BITS);
+}
+
+static inline Coord_Lanes coord_lanes_greater(Coord_Lanes a, Coord_Lanes b) {
+    return _mm_cmpgt_epi16(a, b);
+}
+
+static inline Coord_Lanes coord_lanes_and(Coord_Lanes a, Coord_Lanes b) {
+    return _mm_and_si128(a, b);
+}
+
+/// Bit i set if the top bit of lane i is.
+static inline uint32_t coord_lanes_bits(Coord_Lanes a) {
+    return _mm_movemask_epi8(_mm_packs_epi16(a, _mm_setzero_si128()));
+}
+
+#elif PEW_SIMD == PEW_SIMD_NEON
+
+#include <arm_neon.h>
+
+typedef int32x4_t Lanes;
+
+static inline Lanes lanes_load(const Fou_Num* p) {
+    return vld1q_s32(p);
+}
+
+typedef int16x8_t Coord_Lanes;
+
+static inline Coord_Lanes coord_lanes_load(const Fou_Coord* p) {
+    return vld1q_s16(p);
+}
+
+static inline void coord_lanes_store(Fou_Coord* p, Coord_Lanes v) {
+    vst1q_s16(p, v);
+}
+
+static inline Coord_Lanes coord_lanes_splat(int16_t value) {
+    return vdupq_n_s16(value);
+}
+
+static inline Coord_Lanes coord_lanes_add(Coord_Lanes a, Coord_Lanes b) {
+    return vaddq_s16(a, b);
+}
+
+/// fou_coord_from_num of the lanes of `low`, then those of `high`.
+static inline Coord_Lanes coord_lanes_from_num(Lanes low, Lanes high) {
+    Lanes half = vdupq_n_s32(1 << (FOU_COORD_SHIFT - 1));
+    return vcombine_s16(
+        vqmovn_s32(vshrq_n_s32(vaddq_s32(low, half), FOU_COORD_SHIFT)),
+        vqmovn_s32(vshrq_n_s32(vaddq_s32(high, half), FOU_COORD_SHIFT)));
+}
+
+/// fou_coord_to_int of every lane.
+static inline Coord_Lanes coord_lanes_to_int(Coord_Lanes a) {
+    return vshrq_n_s16(a, FOU_COORD_FRAC_BITS);
+}
+
+static inline Coord_Lanes coord_lanes_greater(Coord_Lanes a, Coord_Lanes b) {
+    return vreinterpretq_s16_u16(vcgtq_s16(a, b));
+}
+
+static inline Coord_Lanes coord_lanes_and(Coord_Lanes a, Coord_Lanes b) {
+    return vandq_s16(a, b);
+}
+
+/// Bit i set if the top bit of lane i is. There is no movemask, every lane's
+/// top bit is moved to bit i of it and the lanes are added up.
+static inline uint32_t coord_lanes_bits(Coord_Lanes a) {
+    static const int16_t lane_shift[COORD_LANES] = {0, 1, 2, 3, 4, 5, 6, 7};
+    uint16x8_t top = vshrq_n_u16(vreinterpretq_u16_s16(a), 15);
+    return vaddvq_u16(vshlq_u16(top, vld1q_s16(lane_shift)));
+}
+
+#elif PEW_SIMD == PEW_SIMD_DSP
+
+#include <arm_acle.h>
+#include <string.h>
+
+// The M4's DSP instructions work on two 16 bit lanes of a register, eight
+// coordinates take four of them. Its Fou_Nums are only ever converted to
+// coordinates, one at a time.
+
+typedef struct {
+    Fou_Num lane[LANES];
+} Lanes;
+
+static inline Lanes lanes_load(const Fou_Num* p) {
+    Lanes v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+typedef struct {
+    int16x2_t pair[COORD_LANES / 2];
+} Coord_Lanes;
+
+static inline Coord_Lanes coord_lanes_load(const Fou_Coord* p) {
+    Coord_Lanes v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline void coord_lanes_store(Fou_Coord* p, Coord_Lanes v) {
+    memcpy(p, &v, sizeof(v));
+}
+
+/// Lane 0 in the low half, lane 1 in the high half.
+static inline int16x2_t coord_pair(int low, int high) {
+    return (int16x2_t)((uint16_t)low | (uint32_t)(uint16_t)high << 16);
+}
+
+static inline Coord_Lanes coord_lanes_splat(int16_t value) {
+    Coord_Lanes v;
+    for (int k = 0; k < COORD_LANES / 2; k++) {
+        v.pair[k] = coord_pair(value, value);
+    }
+    return v;
+}
+
+static inline Coord_Lanes coord_lanes_add(Coord_Lanes a, Coord_Lanes b) {
+    for (int k = 0; k < COORD_LANES / 2; k++) {
+        a.pair[k] = __sadd16(a.pair[k], b.pair[k]);
+    }
+    return a;
+}
+
+/// fou_coord_from_num of the lanes of `low`, then those of `high`.
+static inline Coord_Lanes coord_lanes_from_num(Lanes low, Lanes high) {
+    Coord_Lanes v;
+    for (int k = 0; k < LANES / 2; k++) {
+        v.pair[k] = coord_pair(
+            fou_coord_from_num(low.lane[2 * k]), fou_coord_from_num(low.lane[2 * k + 1]));
+        v.pair[LANES / 2 + k] = coord_pair(
+            fou_coord_from_num(high.lane[2 * k]), fou_coord_from_num(high.lane[2 * k + 1]));
+    }
+    return v;
+}
+
+/// fou_coord_to_int of every lane. There are no 16 bit shifts, each half is
+/// shifted on its own.
+static inline Coord_Lanes coord_lanes_to_int(Coord_Lanes a) {
+    for (int k = 0; k < COORD_LANES / 2; k++) {
+        int32_t p = a.pair[k];
+        a.pair[k] = coord_pair(
+            (int32_t)((uint32_t)p << 16) >> (16 + FOU_COORD_FRAC_BITS),
+            p >> (16 + FOU_COORD_FRAC_BITS));
+    }
+    return a;
+}
+
+/// b - a, saturated so its sign is right, is negative where a > b.
+static inline Coord_Lanes coord_lanes_greater(Coord_Lanes a, Coord_Lanes b) {
+    for (int k = 0; k < COORD_LANES / 2; k++) {
+        a.pair[k] = __qsub16(b.pair[k], a.pair[k]);
+    }
+    return a;
 }
 
-void pew_remove(Pews* pews, const int index) {
-    furi_assert(pews->len == 0, "cannot remove from empty pew");
-    furi_assert(index >= pews->len, "index out of bounds");
-    for (int i = index; i < pews->len - 1; i++) {
-        pews->items[i] = pews->items[i + 1];
+static inline Coord_Lanes coord_lanes_and(Coord_Lanes a, Coord_Lanes b) {
+    for (int k = 0; k < COORD_LANES / 2; k++) {
+        a.pair[k] &= b.pair[k];
     }
-    pews->len--;
+    return a;
 }
 
-void enemypews_add(Enemy_Pews* enemy_pews, EnemyPew enemey_pew) {
-    (void)enemy_pews;
-    (void)enemey_pew;
-    if (enemy_pews->len + 1 != ENEMY_PEW_CAP) {
-        enemy_pews->items[enemy_pews->len++] = enemey_pew;
+/// Bit i set if the top bit of lane i is.
+static inline uint32_t coord_lanes_bits(Coord_Lanes a) {
+    uint32_t bits = 0;
+    for (int k = 0; k < COORD_LANES / 2; k++) {
+        uint32_t p = a.pair[k];
+        bits |= ((p >> 15 & 1) | (p >> 30 & 2)) << (2 * k);
     }
+    return bits;
 }
 
-void enemypew_remove(Enemy_Pews* enemypews, int index) {
-    (void)enemypews;
-    (void)index;
-    for (int i = index; i < enemypews->len - 1; i++) {
-        enemypews->items[i] = enemypews->items[i + 1];
+#endif
+
+#define ALL_COORD_LANES ((1u << COORD_LANES) - 1)
+
+static inline void set_bit(uint32_t* bits, int index) {
+    bits[index / 32] |= 1u << (index % 32);
+}
+
+/// Same as check_collision of the pew's whole pixel hitbox and the rectangle.
+static inline bool overlaps(
+    Fou_Coord x,
+    Fou_Coord y,
+    int width,
+    int height,
+    int rect_x,
+    int rect_y,
+    int rect_w,
+    int rect_h)
+{
+    int px = fou_coord_to_int(x);
+    int py = fou_coord_to_int(y);
+    return px + width > rect_x && px < rect_x + rect_w && py + height > rect_y &&
+           py < rect_y + rect_h;
+}
+
+// Every field of a slot, see pool.h.
+#define PEW_FIELDS(pews) {POOL_FIELD((pews)->x), POOL_FIELD((pews)->y)}
+#define ENEMY_PEW_FIELDS(pews)                                                          \
+    {POOL_FIELD((pews)->x), POOL_FIELD((pews)->y), POOL_FIELD((pews)->v_speed),         \
+     POOL_FIELD((pews)->h_speed), POOL_FIELD((pews)->param), POOL_FIELD((pews)->ticks)}
+
+/// How many bits of `bits` are set below `end`.
+static int count_bits(const uint32_t* bits, int end) {
+    int count = 0;
+    for (int w = 0; w < end / 32; w++) {
+        count += __builtin_popcount(bits[w]);
+    }
+    if (end % 32 != 0) {
+        count += __builtin_popcount(bits[end / 32] & ((1u << (end % 32)) - 1));
+    }
+    return count;
+}
+
+bool pew_add(Pews* pews, Pew pew) {
+    if (pews->len == PEW_CAP) {
+        pews->dropped++;
+        return false;
+    }
+    pews->x[pews->len] = fou_coord_from_num(pew.x);
+    pews->y[pews->len] = fou_coord_from_num(pew.y);
+    pews->len++;
+    return true;
+}
+
+void pew_mark(Pews* pews, int index) {
+    furi_assert(index >= 0 && index < pews->len, "index out of bounds");
+    set_bit(pews->marked, index);
+}
+
+void pew_unmark(Pews* pews, int index) {
+    furi_assert(index >= 0 && index < pews->len, "index out of bounds");
+    pews->marked[index / 32] &= ~(1u << (index % 32));
+}
+
+void pew_compact(Pews* pews) {
+    Pool_Field fields[] = PEW_FIELDS(pews);
+    pews->len = pool_remove_slots(fields, POOL_FIELD_COUNT(fields), pews->marked, pews->len);
+    for (int w = 0; w < POOL_MASK_WORDS(PEW_CAP); w++) {
+        pews->marked[w] = 0;
+    }
+}
+
+void pew_advance(Pews* pews, Fou_Num speed, Fou_Num max_x) {
+    uint32_t gone[POOL_MASK_WORDS(PEW_CAP)] = {0};
+    Fou_Coord coord_speed = fou_coord_from_num(speed);
+    Fou_Coord coord_max_x = fou_coord_from_num(max_x);
+    int i = 0;
+#if PEW_SIMD
+    Coord_Lanes lanes_speed = coord_lanes_splat(coord_speed);
+    Coord_Lanes lanes_max_x = coord_lanes_splat(coord_max_x);
+    for (; i + COORD_LANES <= pews->len; i += COORD_LANES) {
+        Coord_Lanes x = coord_lanes_add(coord_lanes_load(&pews->x[i]), lanes_speed);
+        coord_lanes_store(&pews->x[i], x);
+        gone[i / 32] |= coord_lanes_bits(coord_lanes_greater(x, lanes_max_x)) << (i % 32);
+    }
+#endif
+    for (; i < pews->len; i++) {
+        pews->x[i] += coord_speed;
+        if (pews->x[i] > coord_max_x) set_bit(gone, i);
+    }
+    Pool_Field fields[] = PEW_FIELDS(pews);
+    pews->len = pool_remove_slots(fields, POOL_FIELD_COUNT(fields), gone, pews->len);
+}
+
+int pew_mark_overlapping(Pews* pews, int width, int height, int x, int y, int rect_w, int rect_h) {
+    int count = 0;
+    int i = 0;
+#if PEW_SIMD
+    // px + width > x && px < x + rect_w, the same for y
+    Coord_Lanes min_x = coord_lanes_splat(x - width);
+    Coord_Lanes max_x = coord_lanes_splat(x + rect_w);
+    Coord_Lanes min_y = coord_lanes_splat(y - height);
+    Coord_Lanes max_y = coord_lanes_splat(y + rect_h);
+    for (; i + COORD_LANES <= pews->len; i += COORD_LANES) {
+        Coord_Lanes px = coord_lanes_to_int(coord_lanes_load(&pews->x[i]));
+        Coord_Lanes py = coord_lanes_to_int(coord_lanes_load(&pews->y[i]));
+        Coord_Lanes hit = coord_lanes_and(
+            coord_lanes_and(coord_lanes_greater(px, min_x), coord_lanes_greater(max_x, px)),
+            coord_lanes_and(coord_lanes_greater(py, min_y), coord_lanes_greater(max_y, py)));
+        uint32_t bits = coord_lanes_bits(hit);
+        pews->marked[i / 32] |= bits << (i % 32);
+        count += __builtin_popcount(bits);
+    }
+#endif
+    for (; i < pews->len; i++) {
+        if (overlaps(pews->x[i], pews->y[i], width, height, x, y, rect_w, rect_h)) {
+            set_bit(pews->marked, i);
+            count++;
+        }
+    }
+    return count;
+}
+
+bool enemypew_add(Enemy_Pews* pews, EnemyPew pew) {
+    int index;
+    if (enemypew_reserve(pews, pew.behavior, 1, &index) == 0) {
+        return false;
+    }
+    pews->x[index] = fou_coord_from_num(pew.x);
+    pews->y[index] = fou_coord_from_num(pew.y);
+    pews->v_speed[index] = pew.v_speed;
+    pews->h_speed[index] = pew.h_speed;
+    pews->param[index] = pew.param;
+    pews->ticks[index] = pew.ticks;
+    return true;
+}
+
+int enemypew_reserve(Enemy_Pews* pews, Enemy_Pew_Behavior behavior, int count, int* first) {
+    int free_slots = ENEMY_PEW_CAP - pews->len;
+    if (count > free_slots) {
+        pews->dropped += count - free_slots;
+        count = free_slots;
+    }
+    // every later group moves `count` slots up, only the pews at its start
+    // have to, they go to its end
+    Pool_Field fields[] = ENEMY_PEW_FIELDS(pews);
+    for (int b = ENEMY_PEW_BEHAVIOR_COUNT - 1; b > (int)behavior; b--) {
+        int start = enemypew_group_start(pews, b);
+        int end = pews->group_end[b];
+        int moved = end - start < count ? end - start : count;
+        for (int i = 0; i < moved; i++) {
+            pool_move_slot(fields, POOL_FIELD_COUNT(fields), start + i, end + count - moved + i);
+        }
+        pews->group_end[b] += count;
+    }
+    *first = pews->group_end[behavior];
+    pews->group_end[behavior] += count;
+    pews->len += count;
+    return count;
+}
+
+void enemypew_clear(Enemy_Pews* pews) {
+    pews->len = 0;
+    for (int b = 0; b < ENEMY_PEW_BEHAVIOR_COUNT; b++) {
+        pews->group_end[b] = 0;
+    }
+}
+
+// One kernel per behavior, each moves the pews at [start, end) by a tick.
+
+/// Move the pew at `i` by its speed.
+static inline void move(Enemy_Pews* pews, int i) {
+    pews->x[i] += fou_coord_from_num(pews->h_speed[i]);
+    pews->y[i] += fou_coord_from_num(pews->v_speed[i]);
+}
+
+static void advance_straight(Enemy_Pews* pews, int start, int end) {
+    int i = start;
+#if PEW_SIMD
+    for (; i + COORD_LANES <= end; i += COORD_LANES) {
+        Coord_Lanes h = coord_lanes_from_num(
+            lanes_load(&pews->h_speed[i]), lanes_load(&pews->h_speed[i + LANES]));
+        Coord_Lanes v = coord_lanes_from_num(
+            lanes_load(&pews->v_speed[i]), lanes_load(&pews->v_speed[i + LANES]));
+        coord_lanes_store(&pews->x[i], coord_lanes_add(coord_lanes_load(&pews->x[i]), h));
+        coord_lanes_store(&pews->y[i], coord_lanes_add(coord_lanes_load(&pews->y[i]), v));
+    }
+#endif
+    for (; i < end; i++) {
+        move(pews, i);
+    }
+}
+
+static void advance_accelerating(Enemy_Pews* pews, int start, int end) {
+    for (int i = start; i < end; i++) {
+        int accelerating = pews->ticks[i] != 0;
+        pews->ticks[i] -= accelerating;
+        Fou_Num gain = pews->param[i] * accelerating;
+        pews->h_speed[i] += fou_num_mul(pews->h_speed[i], gain);
+        pews->v_speed[i] += fou_num_mul(pews->v_speed[i], gain);
+        move(pews, i);
+    }
+}
+
+/// A full swing every 32 ticks.
+#define WAVE_TURN (0x10000 / 32)
+
+static void advance_wave(Enemy_Pews* pews, int start, int end) {
+    for (int i = start; i < end; i++) {
+        Fou_Angle phase = (Fou_Angle)(pews->ticks[i] * WAVE_TURN);
+        Fou_Num swing = fou_num_mul(pews->param[i], fou_cos(phase));
+        pews->ticks[i]++;
+        // the speed turned by a right angle, times the swing
+        pews->x[i] += fou_coord_from_num(pews->h_speed[i] - fou_num_mul(pews->v_speed[i], swing));
+        pews->y[i] += fou_coord_from_num(pews->v_speed[i] + fou_num_mul(pews->h_speed[i], swing));
+    }
+}
+
+/// How far homing pews turn every tick.
+#define HOMING_TURN FOU_ANGLE_DEGREES(4)
+
+static void advance_homing(
+    Enemy_Pews* pews,
+    int start,
+    int end,
+    Fou_Num target_x,
+    Fou_Num target_y)
+{
+    Fou_Num turn_cos = fou_cos(HOMING_TURN);
+    Fou_Num turn_sin = fou_sin(HOMING_TURN);
+    for (int i = start; i < end; i++) {
+        Fou_Num h = pews->h_speed[i];
+        Fou_Num v = pews->v_speed[i];
+        // the sign of the cross product is the side the target is on, 0 once
+        // the pew stopped homing
+        Fou_Num cross = fou_num_mul(h, target_y - fou_num_from_coord(pews->y[i])) -
+                        fou_num_mul(v, target_x - fou_num_from_coord(pews->x[i]));
+        int homing = pews->ticks[i] != 0;
+        pews->ticks[i] -= homing;
+        int side = ((cross > 0) - (cross < 0)) * homing;
+        Fou_Num c = FOU_NUM_ONE - (FOU_NUM_ONE - turn_cos) * (side * side);
+        Fou_Num s = turn_sin * side;
+        pews->h_speed[i] = fou_num_mul(h, c) - fou_num_mul(v, s);
+        pews->v_speed[i] = fou_num_mul(h, s) + fou_num_mul(v, c);
+        move(pews, i);
+    }
+}
+
+/// Sets the bit in `split` of every pew whose fuse ran out.
+static void advance_split(Enemy_Pews* pews, int start, int end, uint32_t* split) {
+    for (int i = start; i < end; i++) {
+        move(pews, i);
+        pews->ticks[i]--;
+        split[i / 32] |= (uint32_t)(pews->ticks[i] == 0) << (i % 32);
+    }
+}
+
+#define SPLIT_COUNT 6
+/// Rings of more split pews than this could never fit into the pool.
+#define MAX_SPLITS ((ENEMY_PEW_CAP + SPLIT_COUNT - 1) / SPLIT_COUNT)
+
+void enemypew_advance(
+    Enemy_Pews* pews,
+    int width,
+    int height,
+    int screen_w,
+    int screen_h,
+    Fou_Num target_x,
+    Fou_Num target_y)
+{
+    uint32_t gone[POOL_MASK_WORDS(ENEMY_PEW_CAP)] = {0};
+    uint32_t split[POOL_MASK_WORDS(ENEMY_PEW_CAP)] = {0};
+    const int* end = pews->group_end;
+    advance_straight(pews, 0, end[ENEMY_PEW_STRAIGHT]);
+    advance_accelerating(
+        pews, enemypew_group_start(pews, ENEMY_PEW_ACCELERATING), end[ENEMY_PEW_ACCELERATING]);
+    advance_wave(pews, enemypew_group_start(pews, ENEMY_PEW_WAVE), end[ENEMY_PEW_WAVE]);
+    advance_homing(
+        pews,
+        enemypew_group_start(pews, ENEMY_PEW_HOMING),
+        end[ENEMY_PEW_HOMING],
+        target_x,
+        target_y);
+    advance_split(pews, enemypew_group_start(pews, ENEMY_PEW_SPLIT), end[ENEMY_PEW_SPLIT], split);
+
+    int i = 0;
+#if PEW_SIMD
+    // on screen: px + width > 0 && px < screen_w, the same for y
+    Coord_Lanes min_x = coord_lanes_splat(-width);
+    Coord_Lanes max_x = coord_lanes_splat(screen_w);
+    Coord_Lanes min_y = coord_lanes_splat(-height);
+    Coord_Lanes max_y = coord_lanes_splat(screen_h);
+    for (; i + COORD_LANES <= pews->len; i += COORD_LANES) {
+        Coord_Lanes px = coord_lanes_to_int(coord_lanes_load(&pews->x[i]));
+        Coord_Lanes py = coord_lanes_to_int(coord_lanes_load(&pews->y[i]));
+        Coord_Lanes on_screen = coord_lanes_and(
+            coord_lanes_and(coord_lanes_greater(px, min_x), coord_lanes_greater(max_x, px)),
+            coord_lanes_and(coord_lanes_greater(py, min_y), coord_lanes_greater(max_y, py)));
+        gone[i / 32] |= (coord_lanes_bits(on_screen) ^ ALL_COORD_LANES) << (i % 32);
+    }
+#endif
+    for (; i < pews->len; i++) {
+        if (!overlaps(pews->x[i], pews->y[i], width, height, 0, 0, screen_w, screen_h)) {
+            set_bit(gone, i);
+        }
+    }
+
+    // the few pews that split are looked at one by one
+    EnemyPew splits[MAX_SPLITS];
+    int split_count = 0;
+    for (int w = 0; w < POOL_MASK_WORDS(ENEMY_PEW_CAP); w++) {
+        gone[w] |= split[w];
+        for (uint32_t bits = split[w]; bits != 0; bits &= bits - 1) {
+            if (split_count == MAX_SPLITS) break;
+            splits[split_count++] = enemypew_get(pews, w * 32 + __builtin_ctz(bits));
+        }
+    }
+
+    for (int b = 0; b < ENEMY_PEW_BEHAVIOR_COUNT; b++) {
+        pews->group_end[b] -= count_bits(gone, pews->group_end[b]);
+    }
+    Pool_Field fields[] = ENEMY_PEW_FIELDS(pews);
+    pews->len = pool_remove_slots(fields, POOL_FIELD_COUNT(fields), gone, pews->len);
+
+    for (int p = 0; p < split_count; p++) {
+        int first;
+        int count = enemypew_reserve(pews, ENEMY_PEW_STRAIGHT, SPLIT_COUNT, &first);
+        Fou_Angle angle = 0;
+        EnemyPew parent = splits[p];
+        for (int k = first; k < first + count; k++) {
+            Fou_Num c = fou_cos(angle);
+            Fou_Num s = fou_sin(angle);
+            pews->x[k] = fou_coord_from_num(parent.x);
+            pews->y[k] = fou_coord_from_num(parent.y);
+            pews->h_speed[k] = fou_num_mul(parent.h_speed, c) - fou_num_mul(parent.v_speed, s);
+            pews->v_speed[k] = fou_num_mul(parent.h_speed, s) + fou_num_mul(parent.v_speed, c);
+            pews->param[k] = 0;
+            pews->ticks[k] = 0;
+            angle += 0x10000 / SPLIT_COUNT;
+        }
+    }
+}
+
+int enemypew_find_overlapping(
+    const Enemy_Pews* pews,
+    int width,
+    int height,
+    int x,
+    int y,
+    int rect_w,
+    int rect_h,
+    uint32_t found[POOL_MASK_WORDS(ENEMY_PEW_CAP)])
+{
+    for (int w = 0; w < POOL_MASK_WORDS(ENEMY_PEW_CAP); w++) {
+        found[w] = 0;
+    }
+    int count = 0;
+    int i = 0;
+#if PEW_SIMD
+    Coord_Lanes min_x = coord_lanes_splat(x - width);
+    Coord_Lanes max_x = coord_lanes_splat(x + rect_w);
+    Coord_Lanes min_y = coord_lanes_splat(y - height);
+    Coord_Lanes max_y = coord_lanes_splat(y + rect_h);
+    for (; i + COORD_LANES <= pews->len; i += COORD_LANES) {
+        Coord_Lanes px = coord_lanes_to_int(coord_lanes_load(&pews->x[i]));
+        Coord_Lanes py = coord_lanes_to_int(coord_lanes_load(&pews->y[i]));
+        Coord_Lanes hit = coord_lanes_and(
+            coord_lanes_and(coord_lanes_greater(px, min_x), coord_lanes_greater(max_x, px)),
+            coord_lanes_and(coord_lanes_greater(py, min_y), coord_lanes_greater(max_y, py)));
+        uint32_t bits = coord_lanes_bits(hit);
+        found[i / 32] |= bits << (i % 32);
+        count += __builtin_popcount(bits);
+    }
+#endif
+    for (; i < pews->len; i++) {
+        if (overlaps(pews->x[i], pews->y[i], width, height, x, y, rect_w, rect_h)) {
+            set_bit(found, i);
+            count++;
+        }
     }
-    enemypews->len--;
+    return count;
 }
@@ -1,37 +1,198 @@
+/*
+ * Bullet pools, stored as structure of arrays: one array per field, all
+ * indexed by the same slot. Like the pools of pool.h, bullets live densely in
+ * slots [0, len) and adding to a full pool counts the bullet as dropped.
+ *
+ * Positions are stored as 16 bit Fou_Coords, velocities as Fou_Nums. The
+ * passes run every tick over all bullets are kernels working on whole arrays
+ * at once. With fixed point numbers they use SSE2 on x86 and NEON on 64 bit
+ * ARMs, eight coordinates per instruction, and the DSP instructions of the
+ * Cortex-M4 and other 32 bit ARMs, two coordinates per instruction. Floats
+ * and everything else get the scalar version. Build with PEW_SIMD=0 to force
+ * it.
+ *
+ * Enemy pews do not all fly straight, each has an Enemy_Pew_Behavior. Rather
+ * than switching on it per pew, the pool keeps its pews sorted by behavior
+ * and every behavior's group is moved by a loop of its own. Adding a pew to
+ * a group moves up to as many pews of every later group to the end of it,
+ * removing pews keeps their order and so the groups.
+ */
+
 #ifndef PEW_H
 #define PEW_H
 
+#include <stdbool.h>
+
+#include "fixed.h"
+#include "pool.h"
+
+// the kernels the pools are built with, PEW_SIMD is 0 for the scalar ones
+#define PEW_SIMD_SSE2 1
+#define PEW_SIMD_DSP 2
+#define PEW_SIMD_NEON 3
+
+#ifndef PEW_SIMD
+#if FOU_FIXED_POINT && defined(__SSE2__)
+#define PEW_SIMD PEW_SIMD_SSE2
+#elif FOU_FIXED_POINT && defined(__ARM_NEON) && defined(__aarch64__)
+#define PEW_SIMD PEW_SIMD_NEON
+#elif FOU_FIXED_POINT && defined(__ARM_FEATURE_SIMD32)
+#define PEW_SIMD PEW_SIMD_DSP
+#else
+#define PEW_SIMD 0
+#endif
+#endif
+
+#if PEW_SIMD && !FOU_FIXED_POINT
+#error "the pew kernels only vectorize fixed point numbers"
+#endif
+
+// Eight pews at a time, the overlap kernels scan every pew faster than the
+// ones close to a hitbox are looked up in a broadphase grid. Two at a time
+// they do not. Build with PEW_OVERLAP_SCAN=0 or 1 to force the grid or the
+// scan on any kernels.
+#ifndef PEW_OVERLAP_SCAN
+#define PEW_OVERLAP_SCAN (PEW_SIMD == PEW_SIMD_SSE2 || PEW_SIMD == PEW_SIMD_NEON)
+#endif
+
+#ifndef PEW_CAP
 #define PEW_CAP 32
+#endif
+#ifndef ENEMY_PEW_CAP
 #define ENEMY_PEW_CAP 32
+#endif
 
+/// One player pew, for adding and reading.
 typedef struct {
-    float x;
-    float y;
+    Fou_Num x;
+    Fou_Num y;
 } Pew;
 
-typedef struct {
-    int len;
-    Pew items[PEW_CAP];
-} Pews;
+typedef enum {
+    ENEMY_PEW_STRAIGHT,
+    /// Speeds up by `param` of its speed every tick, for `ticks` more ticks.
+    ENEMY_PEW_ACCELERATING,
+    /// Swings from side to side across its direction, at most `param` times
+    /// its speed. `ticks` counts up, it is where in the swing the pew is.
+    ENEMY_PEW_WAVE,
+    /// Turns towards the target for `ticks` more ticks.
+    ENEMY_PEW_HOMING,
+    /// Breaks into a ring of straight pews in `ticks` ticks.
+    ENEMY_PEW_SPLIT,
+    ENEMY_PEW_BEHAVIOR_COUNT,
+} Enemy_Pew_Behavior;
 
+/// One enemy pew, for adding and reading.
 typedef struct {
-    float x;
-    float y;
-    float v_speed;
-    float h_speed;
+    Fou_Num x;
+    Fou_Num y;
+    Fou_Num v_speed;
+    Fou_Num h_speed;
+    Fou_Num param; // see Enemy_Pew_Behavior
+    uint16_t ticks;
+    uint8_t behavior; // Enemy_Pew_Behavior
 } EnemyPew;
 
 typedef struct {
     int len;
-    EnemyPew items[ENEMY_PEW_CAP];
+    int dropped; // amount of pews that did not fit
+    uint32_t marked[POOL_MASK_WORDS(PEW_CAP)];
+    Fou_Coord x[PEW_CAP];
+    Fou_Coord y[PEW_CAP];
+} Pews;
+
+typedef struct {
+    int len;
+    int dropped; // amount of pews that did not fit
+    // pews of behavior b are at [group_end[b - 1], group_end[b]), the first
+    // group starts at 0 and the last one ends at `len`
+    int group_end[ENEMY_PEW_BEHAVIOR_COUNT];
+    Fou_Coord x[ENEMY_PEW_CAP];
+    Fou_Coord y[ENEMY_PEW_CAP];
+    Fou_Num v_speed[ENEMY_PEW_CAP];
+    Fou_Num h_speed[ENEMY_PEW_CAP];
+    Fou_Num param[ENEMY_PEW_CAP];
+    uint16_t ticks[ENEMY_PEW_CAP];
 } Enemy_Pews;
 
-void pew_add(Pews* pews, Pew pew);
+/// Returns false and counts the pew as dropped if `pews` is full.
+bool pew_add(Pews* pews, Pew pew);
+
+static inline Pew pew_get(const Pews* pews, int index) {
+    return (Pew){.x = fou_num_from_coord(pews->x[index]), .y = fou_num_from_coord(pews->y[index])};
+}
+
+/// Remove marked pews with pew_compact.
+void pew_mark(Pews* pews, int index);
+
+static inline bool pew_marked(const Pews* pews, int index) {
+    return pews->marked[index / 32] & (1u << (index % 32));
+}
+
+void pew_unmark(Pews* pews, int index);
+
+/// Remove the marked pews, keeping the order of the others.
+void pew_compact(Pews* pews);
+
+/// Move every pew `speed` to the right and remove the ones past `max_x`,
+/// keeping the order of the others.
+void pew_advance(Pews* pews, Fou_Num speed, Fou_Num max_x);
+
+/// Mark every pew whose width x height hitbox, at its whole pixel position,
+/// overlaps the given rectangle. Returns how many were marked.
+int pew_mark_overlapping(Pews* pews, int width, int height, int x, int y, int rect_w, int rect_h);
+
+/// Returns false and counts the pew as dropped if `pews` is full.
+bool enemypew_add(Enemy_Pews* pews, EnemyPew pew);
+
+/// Reserve up to `count` consecutive slots of `behavior` starting at
+/// `*first`, returns how many. The caller fills them in.
+int enemypew_reserve(Enemy_Pews* pews, Enemy_Pew_Behavior behavior, int count, int* first);
+
+/// Remove every pew.
+void enemypew_clear(Enemy_Pews* pews);
+
+static inline int enemypew_group_start(const Enemy_Pews* pews, int behavior) {
+    return behavior == 0 ? 0 : pews->group_end[behavior - 1];
+}
 
-void pew_remove(Pews* pews, int idx);
+static inline EnemyPew enemypew_get(const Enemy_Pews* pews, int index) {
+    int behavior = 0;
+    while (index >= pews->group_end[behavior]) behavior++;
+    return (EnemyPew){
+        .x = fou_num_from_coord(pews->x[index]),
+        .y = fou_num_from_coord(pews->y[index]),
+        .v_speed = pews->v_speed[index],
+        .h_speed = pews->h_speed[index],
+        .param = pews->param[index],
+        .ticks = pews->ticks[index],
+        .behavior = behavior,
+    };
+}
 
-void enemypews_add(Enemy_Pews* enemypews, EnemyPew enemey_pew);
+/// Move every pew the way its behavior does, homing pews turn towards
+/// (target_x, target_y). Removes the pews whose width x height hitbox left
+/// the screen_w x screen_h screen and those that split, keeping the order of
+/// the others.
+void enemypew_advance(
+    Enemy_Pews* pews,
+    int width,
+    int height,
+    int screen_w,
+    int screen_h,
+    Fou_Num target_x,
+    Fou_Num target_y);
 
-void enemypew_remove(Enemy_Pews* enemypews, int idx);
+/// Set the bit in `found` of every pew whose width x height hitbox overlaps
+/// the given rectangle, clearing all others. Returns how many were found.
+int enemypew_find_overlapping(
+    const Enemy_Pews* pews,
+    int width,
+    int height,
+    int x,
+    int y,
+    int rect_w,
+    int rect_h,
+    uint32_t found[POOL_MASK_WORDS(ENEMY_PEW_CAP)]);
 
 #endif
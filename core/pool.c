@@ -0,0 +1,58 @@
+#include <stdbool.h>
+#include <string.h>
+
+#include "pool.h"
+
+void pool_move_slot(const Pool_Field* fields, int field_count, int from, int to) {
+    for (int f = 0; f < field_count; f++) {
+        uint8_t* items = fields[f].items;
+        size_t size = fields[f].item_size;
+        // most fields are small numbers, copied without a call to memcpy
+        switch (size) {
+            case 1:
+                items[to] = items[from];
+                break;
+            case 2:
+                ((uint16_t*)items)[to] = ((uint16_t*)items)[from];
+                break;
+            case 4:
+                ((uint32_t*)items)[to] = ((uint32_t*)items)[from];
+                break;
+            default:
+                memcpy(items + to * size, items + from * size, size);
+        }
+    }
+}
+
+/// The first slot from `i` on whose bit in `bits` is `set`, `len` if there is
+/// none.
+static int next_slot(const uint32_t* bits, bool set, int i, int len) {
+    while (i < len) {
+        uint32_t word = set ? bits[i / 32] : ~bits[i / 32];
+        word &= ~0u << (i % 32);
+        if (word != 0) {
+            int found = i - i % 32 + __builtin_ctz(word);
+            return found < len ? found : len;
+        }
+        i += 32 - i % 32;
+    }
+    return len;
+}
+
+int pool_remove_slots(const Pool_Field* fields, int field_count, const uint32_t* gone, int len) {
+    // nothing before the first gone slot moves, every run of kept slots after
+    // it moves down as a whole
+    int kept = next_slot(gone, true, 0, len);
+    int start = kept;
+    while ((start = next_slot(gone, false, start, len)) < len) {
+        int end = next_slot(gone, true, start, len);
+        for (int f = 0; f < field_count; f++) {
+            uint8_t* items = fields[f].items;
+            size_t size = fields[f].item_size;
+            memmove(items + kept * size, items + start * size, (end - start) * size);
+        }
+        kept += end - start;
+        start = end;
+    }
+    return kept;
+}
@@ -0,0 +1,40 @@
+/*
+ * Fixed capacity pools stored as structure of arrays: one array per field,
+ * all indexed by the same slot.
+ *
+ * Items always live densely in slots [0, len), so every field can be iterated
+ * like a plain array. There are two ways to remove items. Moving the last
+ * item into the hole with pool_move_slot is O(1) but does not keep the order
+ * of items. Marking items in a bit mask during a pass and removing them all
+ * at once with pool_remove_slots keeps it.
+ *
+ * Pools describe their fields to these functions with a table of
+ * POOL_FIELDs. Adding to a full pool does not crash, the item is dropped and
+ * counted in the pool's `dropped` instead.
+ */
+
+#ifndef POOL_H
+#define POOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define POOL_MASK_WORDS(cap) (((cap) + 31) / 32)
+
+/// One field array of a pool.
+typedef struct {
+    void* items;
+    size_t item_size;
+} Pool_Field;
+
+#define POOL_FIELD(array) {(array), sizeof((array)[0])}
+#define POOL_FIELD_COUNT(fields) ((int)(sizeof(fields) / sizeof((fields)[0])))
+
+/// Copy the item in slot `from` to slot `to`, field by field.
+void pool_move_slot(const Pool_Field* fields, int field_count, int from, int to);
+
+/// Remove the slots whose bit is set in `gone` from every field, moving the
+/// others to the front in order. Returns how many are left.
+int pool_remove_slots(const Pool_Field* fields, int field_count, const uint32_t* gone, int len);
+
+#endif
@@ -0,0 +1,141 @@
+#include <string.h>
+
+#include "flouhou.h"
+#include "profile.h"
+#include "text.h"
+
+#define ColorWhite 0
+#define ColorBlack 1
+
+#define PROFILE_HUD_US_PER_PIXEL 50
+#define PROFILE_HUD_WIDTH 64
+
+PROFILE_THREAD_LOCAL Profiler fou_profiler;
+
+static const char* const phase_names[PROFILE_PHASE_COUNT] = {
+    [PROFILE_PHASE_TICK] = "tick",
+    [PROFILE_PHASE_INPUT] = "input",
+    [PROFILE_PHASE_PEWS] = "pews",
+    [PROFILE_PHASE_COLLISION] = "collision",
+    [PROFILE_PHASE_ENEMY] = "enemy",
+    [PROFILE_PHASE_DRAW] = "draw",
+    [PROFILE_PHASE_REPLAY] = "replay",
+};
+
+static const uint8_t phase_parents[PROFILE_PHASE_COUNT] = {
+    [PROFILE_PHASE_TICK] = PROFILE_NO_PARENT,
+    [PROFILE_PHASE_INPUT] = PROFILE_PHASE_TICK,
+    [PROFILE_PHASE_PEWS] = PROFILE_PHASE_TICK,
+    [PROFILE_PHASE_COLLISION] = PROFILE_PHASE_TICK,
+    [PROFILE_PHASE_ENEMY] = PROFILE_PHASE_TICK,
+    // also drawn outside of ticks, in between them
+    [PROFILE_PHASE_DRAW] = PROFILE_NO_PARENT,
+    [PROFILE_PHASE_REPLAY] = PROFILE_NO_PARENT,
+};
+
+void profile_init(Profiler* profiler) {
+    memset(profiler, 0, sizeof(*profiler));
+    for (int i = 0; i < PROFILE_PHASE_COUNT; i++) {
+        profiler->phases[i].min = UINT32_MAX;
+    }
+#if defined(__ARM_ARCH_7EM__)
+    // DEMCR.TRCENA, then DWT_CTRL.CYCCNTENA
+    *(volatile uint32_t*)0xE000EDFCu |= 1u << 24;
+    *(volatile uint32_t*)0xE0001000u |= 1u;
+#endif
+}
+
+void profile_record(Profiler* profiler, Profile_Phase phase, uint32_t start, uint32_t end) {
+    Profile_Phase_Stats* stats = &profiler->phases[phase];
+    uint32_t duration = end - start;
+    stats->ring[stats->next % PROFILE_RING_SIZE] = (Profile_Sample){start, duration};
+    stats->next++;
+    if (duration < stats->min) stats->min = duration;
+    if (duration > stats->max) stats->max = duration;
+    stats->total += duration;
+    int bucket = duration == 0 ? 0 : 31 - __builtin_clz(duration);
+    stats->histogram[bucket]++;
+}
+
+const char* profile_phase_name(Profile_Phase phase) {
+    return phase_names[phase];
+}
+
+uint8_t profile_phase_parent(Profile_Phase phase) {
+    return phase_parents[phase];
+}
+
+uint32_t profile_average(const Profiler* profiler, Profile_Phase phase) {
+    const Profile_Phase_Stats* stats = &profiler->phases[phase];
+    return stats->next == 0 ? 0 : stats->total / stats->next;
+}
+
+static int to_pixels(uint32_t clock_ticks) {
+    uint32_t us = clock_ticks / (PROFILE_CLOCK_HZ / 1000000);
+    int pixels = us / PROFILE_HUD_US_PER_PIXEL;
+    return pixels > PROFILE_HUD_WIDTH - 1 ? PROFILE_HUD_WIDTH - 1 : pixels;
+}
+
+void profile_draw_hud(Fou_Render_Target* target, const Profiler* profiler) {
+    int bars = PROFILE_PHASE_COUNT - 1;
+    int top = 64 - 9 - 3 * bars;
+    fou_set_color(target, ColorWhite);
+    fou_draw_box(target, 0, top, PROFILE_HUD_WIDTH + 2, 64 - top);
+    fou_set_color(target, ColorBlack);
+
+    char text[24];
+    uint32_t tick_us = profile_average(profiler, PROFILE_PHASE_TICK) / (PROFILE_CLOCK_HZ / 1000000);
+    text_put_str(text_put_int(text_put_str(text, "tick "), tick_us), "us");
+    fou_draw_str(target, 1, top + 8, text);
+
+    for (int i = 0; i < bars; i++) {
+        Profile_Phase phase = PROFILE_PHASE_TICK + 1 + i;
+        int y = top + 10 + 3 * i;
+        int average = to_pixels(profile_average(profiler, phase));
+        if (average > 0) fou_draw_box(target, 1, y, average, 2);
+        if (profile_count(profiler, phase) != 0) {
+            fou_draw_dot(target, 1 + to_pixels(profiler->phases[phase].max), y);
+        }
+    }
+}
+
+static void put_u32(uint8_t* out, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        out[i] = value >> (8 * i);
+    }
+}
+
+size_t profile_trace_write(
+    const Profiler* profiler,
+    void (*write)(void* context, const void* data, size_t size),
+    void* context)
+{
+    uint8_t header[10];
+    memcpy(header, PROFILE_TRACE_MAGIC, 4);
+    header[4] = PROFILE_TRACE_VERSION;
+    put_u32(&header[5], PROFILE_CLOCK_HZ);
+    header[9] = PROFILE_PHASE_COUNT;
+    write(context, header, sizeof(header));
+    size_t size = sizeof(header);
+
+    for (int phase = 0; phase < PROFILE_PHASE_COUNT; phase++) {
+        const Profile_Phase_Stats* stats = &profiler->phases[phase];
+        const char* name = phase_names[phase];
+        write(context, name, strlen(name) + 1);
+        size += strlen(name) + 1;
+
+        uint32_t count = stats->next < PROFILE_RING_SIZE ? stats->next : PROFILE_RING_SIZE;
+        uint8_t phase_header[3] = {phase_parents[phase], count & 0xff, count >> 8};
+        write(context, phase_header, sizeof(phase_header));
+        size += sizeof(phase_header);
+        for (uint32_t i = stats->next - count; i != stats->next; i++) {
+            const Profile_Sample* sample = &stats->ring[i % PROFILE_RING_SIZE];
+            uint8_t bytes[8];
+            put_u32(&bytes[0], sample->start);
+            put_u32(&bytes[4], sample->duration);
+            write(context, bytes, sizeof(bytes));
+            size += sizeof(bytes);
+        }
+    }
+    return size;
+}
@@ -0,0 +1,137 @@
+/*
+ * Scoped timing of the phases of a tick and of the draw callback.
+ *
+ * Timestamps come from the DWT cycle counter on the Flipper's Cortex-M4 and
+ * from the monotonic clock on the host. Every phase keeps its own ring of the
+ * latest samples, running min/avg/max and a histogram of power of two
+ * duration buckets. A phase is only ever written by one thread, the draw
+ * callback runs on the GUI thread and has its own phase, so nothing needs a
+ * lock. On the host every thread gets its own profiler, for simulating many
+ * games at once.
+ *
+ * Instrumentation compiles to nothing with FOU_PROFILE=0.
+ *
+ * Trace format, all integers little endian:
+ *
+ *   "FOUP", u8 version, u32 clock_hz, u8 phase_count
+ *   per phase: NUL terminated name, u8 parent phase or 0xff, u16 count,
+ *              then count times u32 start and u32 duration, oldest first
+ *
+ * tools/profile_summary.py turns it into a table and flame graph stacks.
+ */
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "flouhou.h"
+
+#ifndef FOU_PROFILE
+#define FOU_PROFILE 1
+#endif
+
+#define PROFILE_TRACE_MAGIC "FOUP"
+#define PROFILE_TRACE_VERSION 1
+#define PROFILE_NO_PARENT 0xff
+
+#ifndef PROFILE_RING_SIZE
+#define PROFILE_RING_SIZE 32
+#endif
+#define PROFILE_HISTOGRAM_BUCKETS 32
+
+typedef enum {
+    PROFILE_PHASE_TICK, // all of fou_frame
+    PROFILE_PHASE_INPUT,
+    PROFILE_PHASE_PEWS, // moving and binning both kinds of pews
+    PROFILE_PHASE_COLLISION,
+    PROFILE_PHASE_ENEMY, // the emitters shooting
+    PROFILE_PHASE_DRAW, // the fou_draw_* calls of a frame
+    PROFILE_PHASE_REPLAY, // handing a recorded frame to the canvas
+    PROFILE_PHASE_COUNT,
+} Profile_Phase;
+
+typedef struct {
+    uint32_t start;
+    uint32_t duration;
+} Profile_Sample;
+
+typedef struct {
+    Profile_Sample ring[PROFILE_RING_SIZE];
+    uint32_t next; // total samples so far, the ring index is next % size
+    uint32_t min;
+    uint32_t max;
+    uint64_t total;
+    uint32_t histogram[PROFILE_HISTOGRAM_BUCKETS]; // bucket i: [2^i, 2^(i+1))
+} Profile_Phase_Stats;
+
+typedef struct {
+    Profile_Phase_Stats phases[PROFILE_PHASE_COUNT];
+} Profiler;
+
+#if defined(__ARM_ARCH_7EM__)
+#define PROFILE_THREAD_LOCAL
+#else
+#define PROFILE_THREAD_LOCAL _Thread_local
+#endif
+
+extern PROFILE_THREAD_LOCAL Profiler fou_profiler;
+
+#if defined(__ARM_ARCH_7EM__)
+// DWT_CYCCNT, counting core clock cycles once profile_init enabled it
+#define PROFILE_CLOCK_HZ 64000000u
+static inline uint32_t profile_clock(void) {
+    return *(volatile uint32_t*)0xE0001004u;
+}
+#else
+#include <time.h>
+#define PROFILE_CLOCK_HZ 1000000000u
+static inline uint32_t profile_clock(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    // wraps every 4.3 seconds, durations are taken modulo 2^32 anyway
+    return (uint32_t)ts.tv_sec * 1000000000u + (uint32_t)ts.tv_nsec;
+}
+#endif
+
+/// Reset all stats and start the clock.
+void profile_init(Profiler* profiler);
+
+void profile_record(Profiler* profiler, Profile_Phase phase, uint32_t start, uint32_t end);
+
+const char* profile_phase_name(Profile_Phase phase);
+
+/// The phase `phase` runs inside of, PROFILE_NO_PARENT for top level ones.
+uint8_t profile_phase_parent(Profile_Phase phase);
+
+static inline uint32_t profile_count(const Profiler* profiler, Profile_Phase phase) {
+    return profiler->phases[phase].next;
+}
+
+/// Mean duration in clock ticks, 0 before the first sample.
+uint32_t profile_average(const Profiler* profiler, Profile_Phase phase);
+
+/// The average time of a tick plus a bar per phase below it, in the order of
+/// Profile_Phase, filled up to the average and with a dot at the max. Sits in
+/// the bottom left corner.
+void profile_draw_hud(Fou_Render_Target* target, const Profiler* profiler);
+
+/// Write the trace to `write`, in as many pieces as it takes. Returns the
+/// total size.
+size_t profile_trace_write(
+    const Profiler* profiler,
+    void (*write)(void* context, const void* data, size_t size),
+    void* context);
+
+#if FOU_PROFILE
+#define PROFILE_BEGIN(phase) uint32_t profile_start_##phase = profile_clock()
+#define PROFILE_END(phase) \
+    profile_record(&fou_profiler, PROFILE_PHASE_##phase, profile_start_##phase, profile_clock())
+#else
+#define PROFILE_BEGIN(phase) do {} while (0)
+#define PROFILE_END(phase) do {} while (0)
+#endif
+
+#endif
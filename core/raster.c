@@ -0,0 +1,402 @@
+#include <string.h>
+
+#include "raster.h"
+#include "sprite.h"
+
+#define RASTER_MAX_DISC_RADIUS RASTER_WIDTH
+
+void raster_clear(Raster* raster) {
+    memset(raster->pixels, 0, sizeof(raster->pixels));
+    raster->color = true;
+    raster->alpha = false;
+    raster->clip = RASTER_ALL_TILES;
+    raster->text_count = 0;
+    raster->text_bytes_used = 0;
+}
+
+bool raster_equal(const Raster* a, const Raster* b) {
+    if (memcmp(a->pixels, b->pixels, sizeof(a->pixels)) != 0) return false;
+    if (a->text_count != b->text_count) return false;
+    for (int i = 0; i < a->text_count; i++) {
+        const Raster_Text* ta = &a->texts[i];
+        const Raster_Text* tb = &b->texts[i];
+        if (ta->x != tb->x || ta->y != tb->y || ta->color != tb->color ||
+            ta->outlined != tb->outlined ||
+            strcmp(raster_text_string(a, ta), raster_text_string(b, tb)) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+uint32_t raster_tiles_covering(Rect rect) {
+    int x0 = rect.x < 0 ? 0 : rect.x;
+    int y0 = rect.y < 0 ? 0 : rect.y;
+    int x1 = rect.x + rect.w > RASTER_WIDTH ? RASTER_WIDTH : rect.x + rect.w;
+    int y1 = rect.y + rect.h > RASTER_HEIGHT ? RASTER_HEIGHT : rect.y + rect.h;
+    if (x0 >= x1 || y0 >= y1) return 0;
+
+    // tile columns of one tile row, repeated for every tile row covered
+    int first_column = x0 / RASTER_TILE_WIDTH;
+    int last_column = (x1 - 1) / RASTER_TILE_WIDTH;
+    uint32_t columns = ((1u << (last_column + 1)) - 1) & ~((1u << first_column) - 1);
+    uint32_t tiles = 0;
+    for (int row = y0 / RASTER_TILE_HEIGHT; row <= (y1 - 1) / RASTER_TILE_HEIGHT; row++) {
+        tiles |= columns << (row * RASTER_WORDS_PER_ROW);
+    }
+    return tiles;
+}
+
+/// Bit `i` set if word `i` of row `y` may be drawn to.
+static inline uint32_t row_clip(const Raster* raster, int y) {
+    return (raster->clip >> (y / RASTER_TILE_HEIGHT * RASTER_WORDS_PER_ROW)) &
+           ((1u << RASTER_WORDS_PER_ROW) - 1);
+}
+
+static inline void apply(uint32_t* word, uint32_t mask, bool color) {
+    if (color) {
+        *word |= mask;
+    } else {
+        *word &= ~mask;
+    }
+}
+
+static inline void replace(uint32_t* word, uint32_t mask, uint32_t bits) {
+    *word = (*word & ~mask) | bits;
+}
+
+/// Fill columns [x0, x1) of row `y`, whole words at a time.
+static void fill_span(Raster* raster, int y, int x0, int x1, bool color) {
+    if (y < 0 || y >= RASTER_HEIGHT) return;
+    if (x0 < 0) x0 = 0;
+    if (x1 > RASTER_WIDTH) x1 = RASTER_WIDTH;
+    if (x0 >= x1) return;
+
+    // rows of clean tiles, like most of a background box in a partial redraw
+    uint32_t clip = row_clip(raster, y);
+    if (clip == 0) return;
+    uint32_t* row = raster->pixels[y];
+    int first = x0 / 32;
+    int last = (x1 - 1) / 32;
+    for (int i = first; i <= last; i++) {
+        uint32_t mask = ~0u;
+        if (i == first) mask &= ~0u << (x0 % 32);
+        if (i == last) mask &= ~0u >> (31 - (x1 - 1) % 32);
+        if ((clip >> i) & 1) {
+            apply(&row[i], mask, color);
+        }
+    }
+}
+
+/// Replace the up to 32 pixels of `mask` at row `y` starting at column `x` with
+/// those of `bits`, set pixels are black.
+static void blit_masked_row(Raster* raster, int y, int x, uint32_t mask, uint32_t bits) {
+    if (y < 0 || y >= RASTER_HEIGHT || x >= RASTER_WIDTH) return;
+    if (x < 0) {
+        if (x <= -32) return;
+        mask >>= -x;
+        bits >>= -x;
+        x = 0;
+    }
+    // a sprite row straddles at most two words
+    uint64_t wide_mask = (uint64_t)mask << (x % 32);
+    uint64_t wide_bits = (uint64_t)bits << (x % 32);
+    uint32_t* row = raster->pixels[y];
+    uint32_t clip = row_clip(raster, y);
+    int word = x / 32;
+    if ((clip >> word) & 1) {
+        replace(&row[word], (uint32_t)wide_mask, (uint32_t)wide_bits);
+    }
+    if (word + 1 < RASTER_WORDS_PER_ROW && ((clip >> (word + 1)) & 1)) {
+        replace(&row[word + 1], (uint32_t)(wide_mask >> 32), (uint32_t)(wide_bits >> 32));
+    }
+}
+
+/// Draw the up to 32 pixels of `bits` at row `y` starting at column `x`.
+static void blit_row(Raster* raster, int y, int x, uint32_t bits, bool color) {
+    blit_masked_row(raster, y, x, bits, color ? bits : 0);
+}
+
+void raster_box(Raster* raster, int x, int y, int width, int height) {
+    for (int row = y; row < y + height; row++) {
+        fill_span(raster, row, x, x + width, raster->color);
+    }
+}
+
+void raster_disc(Raster* raster, int x, int y, int radius) {
+    if (radius < 0) return;
+    if (radius > RASTER_MAX_DISC_RADIUS) radius = RASTER_MAX_DISC_RADIUS;
+
+    // Half the width of the disc at every distance from its center row. Walks
+    // the same midpoint circle as u8g2, which draws vertical lines at columns
+    // x +- cx for rows up to cy away and at x +- cy for rows up to cx away.
+    int half_width[RASTER_MAX_DISC_RADIUS + 2];
+    for (int d = 0; d <= radius + 1; d++) {
+        half_width[d] = -1;
+    }
+    int f = 1 - radius;
+    int ddf_x = 1;
+    int ddf_y = -2 * radius;
+    int cx = 0;
+    int cy = radius;
+    for (;;) {
+        if (cx > half_width[cy]) half_width[cy] = cx;
+        if (cy > half_width[cx]) half_width[cx] = cy;
+        if (cx >= cy) break;
+        if (f >= 0) {
+            cy--;
+            ddf_y += 2;
+            f += ddf_y;
+        }
+        cx++;
+        ddf_x += 2;
+        f += ddf_x;
+    }
+    // a line reaching d rows away covers every row closer to the center too
+    for (int d = radius - 1; d >= 0; d--) {
+        if (half_width[d + 1] > half_width[d]) half_width[d] = half_width[d + 1];
+    }
+
+    for (int dy = -radius; dy <= radius; dy++) {
+        int half = half_width[dy < 0 ? -dy : dy];
+        fill_span(raster, y + dy, x - half, x + half + 1, raster->color);
+    }
+}
+
+void raster_dot(Raster* raster, int x, int y) {
+    if (x < 0 || x >= RASTER_WIDTH || y < 0 || y >= RASTER_HEIGHT) return;
+    if (!((row_clip(raster, y) >> (x / 32)) & 1)) return;
+    apply(&raster->pixels[y][x / 32], 1u << (x % 32), raster->color);
+}
+
+void raster_frame(Raster* raster, int x, int y, int width, int height) {
+    if (width <= 0 || height <= 0) return;
+    fill_span(raster, y, x, x + width, raster->color);
+    fill_span(raster, y + height - 1, x, x + width, raster->color);
+    for (int row = y + 1; row < y + height - 1; row++) {
+        raster_dot(raster, x, row);
+        raster_dot(raster, x + width - 1, row);
+    }
+}
+
+void raster_icon(Raster* raster, int x, int y, Fou_Icon icon) {
+    const Fou_Sprite* sprite = fou_sprite(icon);
+    uint32_t full_row = (1u << sprite->width) - 1;
+    for (int i = 0; i < sprite->height; i++) {
+        if (!raster->alpha) {
+            blit_row(raster, y + i, x, full_row, !raster->color);
+        }
+        blit_row(raster, y + i, x, sprite->rows[i], raster->color);
+    }
+}
+
+void raster_outlined_icon(Raster* raster, int x, int y, Fou_Icon icon) {
+    const Fou_Sprite* sprite = fou_sprite(icon);
+    if (!raster->alpha) {
+        // every copy clears its whole box, only the long way gets that right
+        raster->color = !raster->color;
+        raster_icon(raster, x - 1, y, sprite->outlined_by);
+        raster_icon(raster, x + 1, y, sprite->outlined_by);
+        raster_icon(raster, x, y - 1, sprite->outlined_by);
+        raster_icon(raster, x, y + 1, sprite->outlined_by);
+        raster->color = !raster->color;
+        raster_icon(raster, x, y, icon);
+        return;
+    }
+    // one pass over the rows of the outline, from one pixel above and to the
+    // left of the sprite
+    for (int i = 0; i < sprite->height + 2; i++) {
+        uint32_t rows = i >= 1 && i <= sprite->height ? (uint32_t)sprite->rows[i - 1] << 1 : 0;
+        uint32_t outline = sprite->outline[i];
+        blit_masked_row(raster, y - 1 + i, x - 1, rows | outline, raster->color ? rows : outline);
+    }
+}
+
+void raster_str(Raster* raster, int x, int y, const char* string, Fou_Str_Flags flags) {
+    int len = (flags & FOU_STR_STATIC) ? 0 : strlen(string) + 1;
+    if (raster->text_count == RASTER_MAX_TEXTS ||
+        raster->text_bytes_used + len > RASTER_TEXT_BYTES) {
+        return;
+    }
+    Raster_Text text = {
+        .x = x, .y = y, .color = raster->color, .outlined = flags & FOU_STR_OUTLINED};
+    if (len == 0) {
+        text.static_string = string;
+    } else {
+        memcpy(&raster->text_bytes[raster->text_bytes_used], string, len);
+        text.string_idx = raster->text_bytes_used;
+        raster->text_bytes_used += len;
+    }
+    raster->texts[raster->text_count++] = text;
+}
+
+void raster_invert_color(Raster* raster) {
+    raster->color = !raster->color;
+}
+
+void raster_set_bitmap_mode(Raster* raster, bool alpha) {
+    raster->alpha = alpha;
+}
+
+void raster_set_color(Raster* raster, bool color) {
+    raster->color = color;
+}
+
+static void target_draw_box(void* context, int x, int y, int width, int height) {
+    raster_box(context, x, y, width, height);
+}
+
+static void target_draw_disc(void* context, int x, int y, int radius) {
+    raster_disc(context, x, y, radius);
+}
+
+static void target_draw_dot(void* context, int x, int y) {
+    raster_dot(context, x, y);
+}
+
+static void target_draw_frame(void* context, int x, int y, int width, int height) {
+    raster_frame(context, x, y, width, height);
+}
+
+static void target_draw_icon(void* context, int x, int y, Fou_Icon icon) {
+    raster_icon(context, x, y, icon);
+}
+
+static void target_draw_outlined_icon(void* context, int x, int y, Fou_Icon icon) {
+    raster_outlined_icon(context, x, y, icon);
+}
+
+static void target_draw_str(void* context, int x, int y, const char* string, Fou_Str_Flags flags) {
+    raster_str(context, x, y, string, flags);
+}
+
+static void target_invert_color(void* context) {
+    raster_invert_color(context);
+}
+
+static void target_set_bitmap_mode(void* context, bool alpha) {
+    raster_set_bitmap_mode(context, alpha);
+}
+
+static void target_set_color(void* context, bool color) {
+    raster_set_color(context, color);
+}
+
+static void target_set_draw_priority(void* context, Fou_Draw_Priority priority) {
+    (void)context;
+    (void)priority;
+}
+
+static const Fou_Render_Functions render_functions = {
+    .draw_box = target_draw_box,
+    .draw_disc = target_draw_disc,
+    .draw_dot = target_draw_dot,
+    .draw_frame = target_draw_frame,
+    .draw_icon = target_draw_icon,
+    .draw_outlined_icon = target_draw_outlined_icon,
+    .draw_str = target_draw_str,
+    .invert_color = target_invert_color,
+    .set_bitmap_mode = target_set_bitmap_mode,
+    .set_color = target_set_color,
+    .set_draw_priority = target_set_draw_priority,
+};
+
+Fou_Render_Target raster_render_target(Raster* raster) {
+    return (Fou_Render_Target){.functions = &render_functions, .context = raster};
+}
+
+static void draw_call(Raster* raster, const Draw_List* draw_list, const Draw_Call* dc) {
+    switch (dc->kind) {
+        case DRAW_CALL_FOU_DRAW_BOX:
+            raster_box(
+                raster,
+                dc->fou_draw_box.x,
+                dc->fou_draw_box.y,
+                dc->fou_draw_box.width,
+                dc->fou_draw_box.height);
+            break;
+        case DRAW_CALL_FOU_DRAW_DISC:
+            raster_disc(raster, dc->fou_draw_disc.x, dc->fou_draw_disc.y, dc->fou_draw_disc.radius);
+            break;
+        case DRAW_CALL_FOU_DRAW_DOT:
+            raster_dot(raster, dc->fou_draw_dot.x, dc->fou_draw_dot.y);
+            break;
+        case DRAW_CALL_FOU_DRAW_FRAME:
+            raster_frame(
+                raster,
+                dc->fou_draw_frame.x,
+                dc->fou_draw_frame.y,
+                dc->fou_draw_frame.width,
+                dc->fou_draw_frame.height);
+            break;
+        case DRAW_CALL_FOU_DRAW_ICON:
+            raster_icon(raster, dc->fou_draw_icon.x, dc->fou_draw_icon.y, dc->fou_draw_icon.icon);
+            break;
+        case DRAW_CALL_FOU_DRAW_OUTLINED_ICON:
+            raster_outlined_icon(
+                raster, dc->fou_draw_icon.x, dc->fou_draw_icon.y, dc->fou_draw_icon.icon);
+            break;
+        case DRAW_CALL_FOU_DRAW_STR:
+        case DRAW_CALL_FOU_DRAW_OUTLINED_STR: {
+            Fou_Str_Flags flags = draw_list_owns_string(draw_list, dc->fou_draw_str.string) ?
+                                      FOU_STR_PLAIN :
+                                      FOU_STR_STATIC;
+            if (dc->kind == DRAW_CALL_FOU_DRAW_OUTLINED_STR) flags |= FOU_STR_OUTLINED;
+            raster_str(
+                raster, dc->fou_draw_str.x, dc->fou_draw_str.y, dc->fou_draw_str.string, flags);
+        } break;
+        case DRAW_CALL_FOU_INVERT_COLOR:
+            raster_invert_color(raster);
+            break;
+        case DRAW_CALL_FOU_SET_BITMAP_MODE:
+            raster_set_bitmap_mode(raster, dc->fou_set_bitmap_mode.alpha);
+            break;
+        case DRAW_CALL_FOU_SET_COLOR:
+            raster_set_color(raster, dc->fou_set_color.color);
+            break;
+    }
+}
+
+void raster_draw_list(Raster* raster, const Draw_List* draw_list) {
+    raster_clear(raster);
+    for (size_t i = 0; i < draw_list->calls.size; i++) {
+        draw_call(raster, draw_list, &draw_list->calls.items[i]);
+    }
+}
+
+void raster_draw_list_tiles(
+    Raster* raster,
+    const Draw_List* draw_list,
+    uint32_t tiles,
+    const uint32_t* call_tiles)
+{
+    if (__builtin_popcount(tiles) > RASTER_MAX_PARTIAL_TILES) {
+        raster_draw_list(raster, draw_list);
+        return;
+    }
+
+    // same state as after raster_clear, with only `tiles` cleared
+    for (uint32_t left = tiles; left != 0; left &= left - 1) {
+        int tile = __builtin_ctz(left);
+        int word = tile % RASTER_WORDS_PER_ROW;
+        int y = tile / RASTER_WORDS_PER_ROW * RASTER_TILE_HEIGHT;
+        for (int row = y; row < y + RASTER_TILE_HEIGHT; row++) {
+            raster->pixels[row][word] = 0;
+        }
+    }
+    raster->color = true;
+    raster->alpha = false;
+    raster->clip = tiles;
+    raster->text_count = 0;
+    raster->text_bytes_used = 0;
+
+    for (size_t i = 0; i < draw_list->calls.size; i++) {
+        const Draw_Call* dc = &draw_list->calls.items[i];
+        bool is_draw = dc->kind < DRAW_CALL_FOU_DRAW_STR;
+        if (is_draw && !(call_tiles[i] & tiles)) {
+            continue;
+        }
+        draw_call(raster, draw_list, dc);
+    }
+    raster->clip = RASTER_ALL_TILES;
+}
@@ -0,0 +1,114 @@
+/*
+ * Software rasterizer for the fou_draw_* calls, drawing straight into a packed
+ * 128x64 1bpp framebuffer.
+ *
+ * Pixels are stored row by row in 32 bit words, bit x % 32 of word x / 32 is
+ * the pixel at column x and set pixels are black. On a little endian CPU that
+ * is exactly the XBM layout canvas_draw_xbm takes, so a finished frame goes to
+ * the screen in one call.
+ *
+ * The screen is split into 32 tiles of one word by 8 rows. Drawing can be
+ * clipped to any set of them, so a frame that only changed in a few tiles
+ * only has to be redrawn there, see dirty.h.
+ *
+ * Text needs the firmware's fonts, so strings are not rasterized but collected
+ * in `texts`, to be drawn on top of the finished frame. That is only right as
+ * long as nothing overlaps text that was drawn after it, which holds for the
+ * HUD and the pause screen.
+ */
+
+#ifndef RASTER_H
+#define RASTER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "draw_list.h"
+#include "flouhou.h"
+
+#define RASTER_WIDTH 128
+#define RASTER_HEIGHT 64
+#define RASTER_WORDS_PER_ROW (RASTER_WIDTH / 32)
+
+#define RASTER_TILE_WIDTH 32
+#define RASTER_TILE_HEIGHT 8
+#define RASTER_TILE_COUNT (RASTER_WORDS_PER_ROW * RASTER_HEIGHT / RASTER_TILE_HEIGHT)
+/// Tile (x, y) is bit y * RASTER_WORDS_PER_ROW + x of a tile mask.
+#define RASTER_ALL_TILES 0xffffffffu
+
+#define RASTER_MAX_TEXTS 16
+#define RASTER_TEXT_BYTES 128
+
+typedef struct {
+    int16_t x;
+    int16_t y;
+    bool color;
+    bool outlined; // see FOU_STR_OUTLINED, `color` is the one of the outline
+    uint8_t string_idx; // into Raster.text_bytes, if there is no `static_string`
+    const char* static_string; // see FOU_STR_STATIC
+} Raster_Text;
+
+typedef struct {
+    uint32_t pixels[RASTER_HEIGHT][RASTER_WORDS_PER_ROW];
+    bool color; // true is black, like ColorBlack
+    bool alpha; // bitmap mode, false draws the unset pixels of icons too
+    uint32_t clip; // tiles drawing may touch
+    int text_count;
+    int text_bytes_used;
+    Raster_Text texts[RASTER_MAX_TEXTS];
+    char text_bytes[RASTER_TEXT_BYTES];
+} Raster;
+
+/// White screen, black color, solid bitmap mode, like a freshly reset canvas.
+void raster_clear(Raster* raster);
+
+/// Whether both would put the same frame on the screen.
+bool raster_equal(const Raster* a, const Raster* b);
+
+/// Mask of the tiles `rect` touches.
+uint32_t raster_tiles_covering(Rect rect);
+
+void raster_box(Raster* raster, int x, int y, int width, int height);
+void raster_disc(Raster* raster, int x, int y, int radius);
+void raster_dot(Raster* raster, int x, int y);
+void raster_frame(Raster* raster, int x, int y, int width, int height);
+void raster_icon(Raster* raster, int x, int y, Fou_Icon icon);
+/// In alpha mode, one pass over every row of the outline and the sprite.
+void raster_outlined_icon(Raster* raster, int x, int y, Fou_Icon icon);
+/// Strings that do not fit any more are dropped.
+void raster_str(Raster* raster, int x, int y, const char* string, Fou_Str_Flags flags);
+void raster_invert_color(Raster* raster);
+void raster_set_bitmap_mode(Raster* raster, bool alpha);
+void raster_set_color(Raster* raster, bool color);
+
+/// A render target drawing straight into `raster`. Nothing is ever dropped, the
+/// draw priority does not matter.
+Fou_Render_Target raster_render_target(Raster* raster);
+
+/// Clear `raster` and draw every call of `draw_list` into it.
+void raster_draw_list(Raster* raster, const Draw_List* draw_list);
+
+/// More tiles than this and raster_draw_list_tiles redraws everything, skipping
+/// draws costs about as much as drawing them then.
+#define RASTER_MAX_PARTIAL_TILES (RASTER_TILE_COUNT / 2)
+
+/// Like raster_draw_list but only redraws `tiles`, the rest of the pixels are
+/// kept from whatever frame was drawn before. `call_tiles` holds the tiles
+/// every call touches (see dirty.h), draws entirely outside of `tiles` are
+/// skipped. Text is always collected anew. Above RASTER_MAX_PARTIAL_TILES it
+/// is raster_draw_list and `call_tiles` is not read.
+void raster_draw_list_tiles(
+    Raster* raster,
+    const Draw_List* draw_list,
+    uint32_t tiles,
+    const uint32_t* call_tiles);
+
+static inline const char* raster_text_string(const Raster* raster, const Raster_Text* text) {
+    return text->static_string ? text->static_string : &raster->text_bytes[text->string_idx];
+}
+
+static inline bool raster_pixel(const Raster* raster, int x, int y) {
+    return (raster->pixels[y][x / 32] >> (x % 32)) & 1;
+}
+
+#endif
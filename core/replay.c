@@ -0,0 +1,127 @@
+#include <string.h>
+
+#include "replay.h"
+
+uint8_t replay_pack_input(Fou_User_Input_State input) {
+    return (input.up ? REPLAY_BUTTON_UP : 0) | (input.down ? REPLAY_BUTTON_DOWN : 0) |
+           (input.left ? REPLAY_BUTTON_LEFT : 0) | (input.right ? REPLAY_BUTTON_RIGHT : 0) |
+           (input.shoot ? REPLAY_BUTTON_SHOOT : 0) | (input.back ? REPLAY_BUTTON_BACK : 0);
+}
+
+Fou_User_Input_State replay_unpack_input(uint8_t buttons) {
+    return (Fou_User_Input_State){
+        .up = buttons & REPLAY_BUTTON_UP,
+        .down = buttons & REPLAY_BUTTON_DOWN,
+        .left = buttons & REPLAY_BUTTON_LEFT,
+        .right = buttons & REPLAY_BUTTON_RIGHT,
+        .shoot = buttons & REPLAY_BUTTON_SHOOT,
+        .back = buttons & REPLAY_BUTTON_BACK,
+    };
+}
+
+void replay_recorder_init(Replay_Recorder* recorder) {
+    recorder->filling = 0;
+    atomic_init(&recorder->full, -1);
+    recorder->buttons = 0;
+    recorder->run = 0;
+    recorder->ticks = 0;
+    recorder->overflowed = false;
+
+    Replay_Block* block = &recorder->blocks[0];
+    memcpy(block->bytes, REPLAY_MAGIC, 4);
+    block->bytes[4] = REPLAY_VERSION;
+    block->size = REPLAY_HEADER_SIZE;
+    recorder->blocks[1].size = 0;
+}
+
+static void write_record(Replay_Recorder* recorder) {
+    Replay_Block* block = &recorder->blocks[recorder->filling];
+    uint32_t extra = recorder->run - 1;
+    if (extra < 3) {
+        block->bytes[block->size++] = recorder->buttons | (extra << 6);
+        return;
+    }
+    block->bytes[block->size++] = recorder->buttons | (3 << 6);
+    extra -= 3;
+    while (extra >= 0x80) {
+        block->bytes[block->size++] = 0x80 | (extra & 0x7f);
+        extra >>= 7;
+    }
+    block->bytes[block->size++] = extra;
+}
+
+bool replay_recorder_tick(Replay_Recorder* recorder, Fou_User_Input_State input) {
+    if (recorder->overflowed) return false;
+
+    uint8_t buttons = replay_pack_input(input);
+    bool handed_over = false;
+    if (recorder->run != 0 && (buttons != recorder->buttons || recorder->run == UINT32_MAX)) {
+        // the filling block always has room for one more record
+        write_record(recorder);
+        recorder->run = 0;
+
+        Replay_Block* block = &recorder->blocks[recorder->filling];
+        if (block->size + REPLAY_MAX_RECORD_SIZE > REPLAY_BLOCK_SIZE) {
+            if (atomic_load_explicit(&recorder->full, memory_order_acquire) != -1) {
+                recorder->overflowed = true;
+                return false;
+            }
+            atomic_store_explicit(&recorder->full, recorder->filling, memory_order_release);
+            recorder->filling ^= 1;
+            recorder->blocks[recorder->filling].size = 0;
+            handed_over = true;
+        }
+    }
+    recorder->buttons = buttons;
+    recorder->run++;
+    recorder->ticks++;
+    return handed_over;
+}
+
+const Replay_Block* replay_recorder_full_block(Replay_Recorder* recorder) {
+    int full = atomic_load_explicit(&recorder->full, memory_order_acquire);
+    return full == -1 ? NULL : &recorder->blocks[full];
+}
+
+void replay_recorder_block_written(Replay_Recorder* recorder) {
+    atomic_store_explicit(&recorder->full, -1, memory_order_release);
+}
+
+const Replay_Block* replay_recorder_finish(Replay_Recorder* recorder) {
+    Replay_Block* block = &recorder->blocks[recorder->filling];
+    if (!recorder->overflowed && recorder->run != 0) {
+        write_record(recorder);
+        recorder->run = 0;
+    }
+    return block;
+}
+
+bool replay_player_init(Replay_Player* player, const uint8_t* data, size_t size) {
+    *player = (Replay_Player){.data = data, .size = size, .pos = REPLAY_HEADER_SIZE};
+    return size >= REPLAY_HEADER_SIZE && memcmp(data, REPLAY_MAGIC, 4) == 0 &&
+           data[4] == REPLAY_VERSION;
+}
+
+bool replay_player_next(Replay_Player* player, Fou_User_Input_State* input) {
+    if (player->run_left == 0) {
+        if (player->pos >= player->size) return false;
+        uint8_t record = player->data[player->pos++];
+        uint32_t run = (record >> 6) + 1;
+        if (run == 4) {
+            uint32_t extra = 0;
+            for (int shift = 0;; shift += 7) {
+                if (player->pos >= player->size || shift > 28) return false;
+                uint8_t byte = player->data[player->pos++];
+                extra |= (uint32_t)(byte & 0x7f) << shift;
+                if (!(byte & 0x80)) break;
+            }
+            run += extra;
+        }
+        player->buttons = record & 0x3f;
+        player->run_left = run;
+    }
+    player->run_left--;
+    player->ticks++;
+    *input = replay_unpack_input(player->buttons);
+    return true;
+}
@@ -0,0 +1,105 @@
+/*
+ * Recording and playback of the per-tick input that drives fou_frame.
+ *
+ * fou_frame only depends on the game state and the input of the current and
+ * the previous tick, so a fresh game state plus the input of every tick
+ * reproduces a whole session exactly.
+ *
+ * Stream format: the 4 magic bytes "FOUR", one version byte, then one record
+ * per run of ticks with the same buttons held:
+ *
+ *   bits 0..5  buttons, see REPLAY_BUTTON_*
+ *   bits 6..7  run length - 1, or 3 for runs of 4 ticks and more, in which
+ *              case the run length - 4 follows as a LEB128 varint
+ *
+ * so a change of input every tick costs a byte per tick and holding a button
+ * costs a few bytes no matter for how long.
+ *
+ * The recorder fills one of two fixed blocks while the other one is written
+ * out by whoever does the I/O, see replay_recorder_full_block. Recording
+ * never allocates nor waits.
+ */
+
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "flouhou.h"
+
+#define REPLAY_MAGIC "FOUR"
+#define REPLAY_VERSION 1
+#define REPLAY_HEADER_SIZE 5
+
+#define REPLAY_BUTTON_UP (1 << 0)
+#define REPLAY_BUTTON_DOWN (1 << 1)
+#define REPLAY_BUTTON_LEFT (1 << 2)
+#define REPLAY_BUTTON_RIGHT (1 << 3)
+#define REPLAY_BUTTON_SHOOT (1 << 4)
+#define REPLAY_BUTTON_BACK (1 << 5)
+
+/// A record byte plus the longest varint a uint32_t run length needs.
+#define REPLAY_MAX_RECORD_SIZE 6
+
+#ifndef REPLAY_BLOCK_SIZE
+#define REPLAY_BLOCK_SIZE 512
+#endif
+
+typedef struct {
+    uint8_t bytes[REPLAY_BLOCK_SIZE];
+    size_t size;
+} Replay_Block;
+
+typedef struct {
+    Replay_Block blocks[2];
+    int filling; // block the tick thread appends to, only touched by it
+    atomic_int full; // block waiting to be written out, -1 if there is none
+    uint8_t buttons; // of the current run
+    uint32_t run; // ticks the current run lasted so far, 0 before the first tick
+    uint32_t ticks;
+    // The writer fell behind and a block had nowhere to go. Everything
+    // recorded up to that point is kept, the rest of the session is lost.
+    bool overflowed;
+} Replay_Recorder;
+
+uint8_t replay_pack_input(Fou_User_Input_State input);
+Fou_User_Input_State replay_unpack_input(uint8_t buttons);
+
+/// Start a new stream, the header goes into the first block.
+void replay_recorder_init(Replay_Recorder* recorder);
+
+/// Record the input of one tick. Returns true when a block just filled up and
+/// should be written out.
+bool replay_recorder_tick(Replay_Recorder* recorder, Fou_User_Input_State input);
+
+/// For the I/O side: the block to write out next, NULL if there is none. Call
+/// replay_recorder_block_written once it is written, until then the recorder
+/// does not touch it.
+const Replay_Block* replay_recorder_full_block(Replay_Recorder* recorder);
+void replay_recorder_block_written(Replay_Recorder* recorder);
+
+/// End the stream and return the block holding its tail, to be written out
+/// after any full block. Only call this once nothing records any more.
+const Replay_Block* replay_recorder_finish(Replay_Recorder* recorder);
+
+typedef struct {
+    const uint8_t* data;
+    size_t size;
+    size_t pos;
+    uint8_t buttons;
+    uint32_t run_left; // ticks left of the current record
+    uint32_t ticks; // played so far
+} Replay_Player;
+
+/// Play back a whole stream held in memory. Returns false if `data` is not a
+/// replay this build can play.
+bool replay_player_init(Replay_Player* player, const uint8_t* data, size_t size);
+
+/// Input of the next tick. Returns false once the stream ended, or when it is
+/// cut short.
+bool replay_player_next(Replay_Player* player, Fou_User_Input_State* input);
+
+#endif
@@ -0,0 +1,314 @@
+#include <stddef.h>
+#include <string.h>
+
+#include "rewind.h"
+#include <core/check.h>
+
+#define ColorWhite 0
+#define ColorBlack 1
+
+/// Bytes [start, end) of a Game_State that are part of a snapshot, everything
+/// else is treated as zero.
+typedef struct {
+    size_t start;
+    size_t end;
+} Byte_Range;
+
+/// An array of a pool in Game_State, only its first `len` items are in use.
+/// Parts that are never saved at all have an `item_size` of 0.
+typedef struct {
+    size_t offset;
+    size_t size; // of the whole array
+    size_t item_size;
+    size_t len_offset; // of the pool's int len
+} Pool_Array;
+
+#define POOL_ARRAY(pool, array)                           \
+    {offsetof(Game_State, pool.array),                    \
+     sizeof(((Game_State*)0)->pool.array),                \
+     sizeof(((Game_State*)0)->pool.array[0]),             \
+     offsetof(Game_State, pool.len)}
+
+#define UNSAVED(member) {offsetof(Game_State, member), sizeof(((Game_State*)0)->member), 0, 0}
+
+/// Every pool array, in the order they are laid out in. Particles are only
+/// drawn, never read by the simulation, a restored state starts without
+/// them. The enemies' `slot` array is saved whole, its unused part holds the
+/// free slots.
+static const Pool_Array pool_arrays[] = {
+    POOL_ARRAY(pews, x),
+    POOL_ARRAY(pews, y),
+    POOL_ARRAY(enemy_pews, x),
+    POOL_ARRAY(enemy_pews, y),
+    POOL_ARRAY(enemy_pews, v_speed),
+    POOL_ARRAY(enemy_pews, h_speed),
+    POOL_ARRAY(enemy_pews, param),
+    POOL_ARRAY(enemy_pews, ticks),
+    POOL_ARRAY(enemies, kind),
+    POOL_ARRAY(enemies, hit_cooldown),
+    POOL_ARRAY(enemies, health),
+    POOL_ARRAY(enemies, stage),
+    POOL_ARRAY(enemies, hits_taken),
+    POOL_ARRAY(enemies, spawn_tick),
+    POOL_ARRAY(enemies, x),
+    POOL_ARRAY(enemies, y),
+    POOL_ARRAY(enemies, path),
+    POOL_ARRAY(enemies, emitters),
+    UNSAVED(particles),
+};
+
+#define POOL_ARRAY_COUNT (sizeof(pool_arrays) / sizeof(pool_arrays[0]))
+#define LIVE_RANGES (POOL_ARRAY_COUNT + 1)
+
+/// The parts of `game_state` outside of unused pool slots, in order. Every
+/// range ends with the used part of an array, but the last one.
+static void live_ranges(const Game_State* game_state, Byte_Range ranges[LIVE_RANGES]) {
+    const uint8_t* bytes = (const uint8_t*)game_state;
+    size_t at = 0;
+    for (size_t a = 0; a < POOL_ARRAY_COUNT; a++) {
+        const Pool_Array* array = &pool_arrays[a];
+        furi_assert(array->offset >= at, "pool arrays out of order");
+        int len;
+        memcpy(&len, bytes + array->len_offset, sizeof(len));
+        ranges[a] = (Byte_Range){at, array->offset + array->item_size * len};
+        at = array->offset + array->size;
+    }
+    ranges[POOL_ARRAY_COUNT] = (Byte_Range){at, sizeof(Game_State)};
+}
+
+typedef struct {
+    uint8_t* out; // NULL when only measuring
+    size_t size;
+    size_t skip; // unchanged bytes since the last changed one
+    size_t count_at; // where the count of the current run of changed bytes goes
+    int run_length; // of the current run, 0 if there is none
+} Delta_Writer;
+
+static void delta_put(Delta_Writer* writer, uint8_t byte) {
+    if (writer->out != NULL) writer->out[writer->size] = byte;
+    writer->size++;
+}
+
+static void delta_byte(Delta_Writer* writer, uint8_t x) {
+    if (x == 0) {
+        writer->skip++;
+        writer->run_length = 0;
+        return;
+    }
+    if (writer->run_length == 0 || writer->run_length == 255) {
+        // skips that do not fit a byte are split with empty runs
+        while (writer->skip > 255) {
+            delta_put(writer, 255);
+            delta_put(writer, 0);
+            writer->skip -= 255;
+        }
+        delta_put(writer, writer->skip);
+        writer->count_at = writer->size;
+        delta_put(writer, 0);
+        writer->skip = 0;
+        writer->run_length = 0;
+    }
+    writer->run_length++;
+    if (writer->out != NULL) writer->out[writer->count_at] = writer->run_length;
+    delta_put(writer, x);
+}
+
+static inline uint32_t load_word(const uint8_t* bytes, size_t i) {
+    uint32_t word = 0;
+    if (bytes != NULL) memcpy(&word, bytes + i, sizeof(word));
+    return word;
+}
+
+/// Encode bytes [from, to) of `state` against `base`, either may be NULL for
+/// all zero bytes.
+static void delta_range(
+    Delta_Writer* writer,
+    const uint8_t* base,
+    const uint8_t* state,
+    size_t from,
+    size_t to)
+{
+    size_t i = from;
+    while (i < to) {
+        // most of a state does not change from one tick to the next
+        if (i + 4 <= to && load_word(state, i) == load_word(base, i)) {
+            writer->skip += 4;
+            writer->run_length = 0;
+            i += 4;
+            continue;
+        }
+        uint8_t x = (state != NULL ? state[i] : 0) ^ (base != NULL ? base[i] : 0);
+        delta_byte(writer, x);
+        i++;
+    }
+}
+
+size_t game_state_delta_encode(const Game_State* base, const Game_State* state, uint8_t* out) {
+    Delta_Writer writer = {.out = out};
+    Byte_Range ranges[LIVE_RANGES];
+    live_ranges(state, ranges);
+    size_t at = 0;
+    for (size_t r = 0; r < LIVE_RANGES; r++) {
+        delta_range(&writer, (const uint8_t*)base, NULL, at, ranges[r].start);
+        delta_range(
+            &writer, (const uint8_t*)base, (const uint8_t*)state, ranges[r].start, ranges[r].end);
+        at = ranges[r].end;
+    }
+    return writer.size;
+}
+
+void game_state_delta_apply(Game_State* state, const uint8_t* delta, size_t size) {
+    uint8_t* bytes = (uint8_t*)state;
+    size_t at = 0;
+    size_t pos = 0;
+    while (pos + 2 <= size) {
+        at += delta[pos];
+        size_t count = delta[pos + 1];
+        pos += 2;
+        furi_assert(at + count <= sizeof(Game_State) && pos + count <= size);
+        for (size_t i = 0; i < count; i++) {
+            bytes[at++] ^= delta[pos++];
+        }
+    }
+}
+
+void rewind_init(Rewind_Ring* ring) {
+    ring->first = 0;
+    ring->count = 0;
+    ring->rewinding = false;
+}
+
+static Rewind_Snapshot* snapshot(Rewind_Ring* ring, int index) {
+    return &ring->snapshots[(ring->first + index) % REWIND_MAX_SNAPSHOTS];
+}
+
+static const Rewind_Snapshot* snapshot_const(const Rewind_Ring* ring, int index) {
+    return &ring->snapshots[(ring->first + index) % REWIND_MAX_SNAPSHOTS];
+}
+
+/// Drop the oldest keyframe and the deltas that need it.
+static void drop_oldest_keyframe(Rewind_Ring* ring) {
+    do {
+        ring->first = (ring->first + 1) % REWIND_MAX_SNAPSHOTS;
+        ring->count--;
+    } while (ring->count > 0 && !snapshot(ring, 0)->keyframe);
+}
+
+/// Offset of `size` free bytes following the newest snapshot, making room by
+/// dropping the oldest ones.
+static size_t allocate(Rewind_Ring* ring, size_t size) {
+    if (ring->count == REWIND_MAX_SNAPSHOTS) drop_oldest_keyframe(ring);
+    for (;;) {
+        if (ring->count == 0) return 0;
+        size_t tail = snapshot(ring, 0)->offset;
+        const Rewind_Snapshot* newest = snapshot(ring, ring->count - 1);
+        size_t head = newest->offset + newest->size;
+        if (newest->offset >= tail) {
+            // [tail, head) in use, free space on both sides of it
+            if (head + size <= REWIND_BUFFER_SIZE) return head;
+            if (size <= tail) return 0;
+        } else if (head + size <= tail) {
+            // wrapped around, [head, tail) is free
+            return head;
+        }
+        drop_oldest_keyframe(ring);
+    }
+}
+
+/// Index of the keyframe the snapshot at `index` is restored from.
+static int keyframe_of(const Rewind_Ring* ring, int index) {
+    while (!snapshot_const(ring, index)->keyframe) index--;
+    return index;
+}
+
+void rewind_push(Rewind_Ring* ring, const Game_State* game_state) {
+    bool keyframe = ring->count == 0 ||
+                    ring->count - keyframe_of(ring, ring->count - 1) >= REWIND_KEYFRAME_INTERVAL;
+    const Game_State* base = keyframe ? NULL : &ring->last;
+    size_t size = game_state_delta_encode(base, game_state, NULL);
+    size_t offset = allocate(ring, size);
+    if (!keyframe && ring->count == 0) {
+        // dropped the keyframe the delta was meant for
+        keyframe = true;
+        base = NULL;
+        size = game_state_delta_encode(NULL, game_state, NULL);
+        offset = allocate(ring, size);
+    }
+    furi_check(size <= REWIND_BUFFER_SIZE);
+
+    game_state_delta_encode(base, game_state, &ring->bytes[offset]);
+    *snapshot(ring, ring->count) =
+        (Rewind_Snapshot){.offset = offset, .size = size, .keyframe = keyframe};
+    ring->count++;
+
+    // what the snapshot restores to
+    ring->last = *game_state;
+    Byte_Range ranges[LIVE_RANGES];
+    live_ranges(game_state, ranges);
+    uint8_t* last = (uint8_t*)&ring->last;
+    for (size_t r = 0; r + 1 < LIVE_RANGES; r++) {
+        memset(last + ranges[r].end, 0, ranges[r + 1].start - ranges[r].end);
+    }
+}
+
+bool rewind_restore(const Rewind_Ring* ring, int ticks_back, Game_State* game_state) {
+    int index = ring->count - 1 - ticks_back;
+    if (ticks_back < 0 || index < 0) return false;
+    if (ticks_back == 0) {
+        *game_state = ring->last;
+        return true;
+    }
+    memset(game_state, 0, sizeof(*game_state));
+    for (int i = keyframe_of(ring, index); i <= index; i++) {
+        const Rewind_Snapshot* s = snapshot_const(ring, i);
+        game_state_delta_apply(game_state, &ring->bytes[s->offset], s->size);
+    }
+    return true;
+}
+
+bool rewind_step_back(Rewind_Ring* ring, Game_State* game_state) {
+    if (ring->count < 2) return false;
+    rewind_restore(ring, 1, &ring->last);
+    ring->count--;
+    *game_state = ring->last;
+    return true;
+}
+
+void rewind_frame(
+    Fou_Render_Target* target,
+    Rewind_Ring* ring,
+    Game_State* game_state,
+    Fou_User_Input_State current_frame_input,
+    Fou_User_Input_State prev_frame_input)
+{
+    if (game_state->paused && !ring->rewinding && current_frame_input.left &&
+        !prev_frame_input.left) {
+        ring->rewinding = true;
+    }
+    if (!ring->rewinding) {
+        fou_frame(target, game_state, current_frame_input, prev_frame_input);
+        if (!game_state->paused) {
+            rewind_push(ring, game_state);
+        }
+        return;
+    }
+
+    if (current_frame_input.left) {
+        rewind_step_back(ring, game_state);
+    }
+    // snapshots are never taken while paused
+    game_state->paused = true;
+    if (current_frame_input.shoot) {
+        ring->rewinding = false;
+        game_state->paused = false;
+    } else if (current_frame_input.back && !prev_frame_input.back) {
+        ring->rewinding = false;
+    }
+
+    fou_draw_game(target, game_state);
+    fou_set_color(target, ColorWhite);
+    fou_draw_box(target, 34, 50, 60, 12);
+    fou_set_color(target, ColorBlack);
+    fou_draw_frame(target, 34, 50, 60, 12);
+    fou_draw_static_str(target, 37, 59, ring->count > 1 ? "<< Rewind" : "| Rewind");
+}
@@ -0,0 +1,98 @@
+/*
+ * Save states of the last few seconds of play, for rewinding.
+ *
+ * Game_State is plain data, so a snapshot is just its bytes. The ring keeps a
+ * keyframe every REWIND_KEYFRAME_INTERVAL snapshots and XOR deltas against the
+ * previous snapshot in between, both run-length encoded:
+ *
+ *   repeated: one byte of unchanged bytes to skip, one byte count n, then n
+ *             bytes to XOR in
+ *
+ * A keyframe is a delta against an all zero state. Bullet slots past the end
+ * of their pool are not part of a snapshot, they always restore as zero. The
+ * same goes for the particles, which are only ever drawn.
+ *
+ * When the ring runs full the oldest keyframe goes, together with the deltas
+ * that depend on it. Restoring a snapshot replays at most one keyframe
+ * interval worth of deltas.
+ */
+
+#ifndef REWIND_H
+#define REWIND_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "flouhou.h"
+
+/// Most bytes a delta can take, with every other byte changed.
+#define GAME_STATE_MAX_DELTA_SIZE (sizeof(Game_State) * 3 / 2 + 2)
+
+// Builds with raised bullet capacities get room for at least one keyframe of
+// a full state.
+#ifndef REWIND_BUFFER_SIZE
+#define REWIND_BUFFER_SIZE \
+    ((int)(GAME_STATE_MAX_DELTA_SIZE > 6144 ? GAME_STATE_MAX_DELTA_SIZE : 6144))
+#endif
+#ifndef REWIND_MAX_SNAPSHOTS
+#define REWIND_MAX_SNAPSHOTS 128 // 8 seconds at 16 ticks per second
+#endif
+#define REWIND_KEYFRAME_INTERVAL 16
+
+typedef struct {
+    uint16_t offset; // into Rewind_Ring.bytes
+    uint16_t size;
+    bool keyframe;
+} Rewind_Snapshot;
+
+_Static_assert(REWIND_BUFFER_SIZE <= UINT16_MAX, "snapshot offsets are 16 bit");
+
+typedef struct {
+    uint8_t bytes[REWIND_BUFFER_SIZE];
+    Rewind_Snapshot snapshots[REWIND_MAX_SNAPSHOTS];
+    int first; // oldest snapshot
+    int count;
+    // The newest snapshot, with unused bullet slots zeroed, the next delta is
+    // taken against it.
+    Game_State last;
+    bool rewinding; // see rewind_frame
+} Rewind_Ring;
+
+/// Encode the difference between `base` and `state` into `out`, which must hold
+/// GAME_STATE_MAX_DELTA_SIZE bytes. NULL `base` stands for an all zero state,
+/// NULL `out` only measures. Returns the size of the delta.
+size_t game_state_delta_encode(const Game_State* base, const Game_State* state, uint8_t* out);
+
+/// Turn the base `state` a delta was encoded against into the state it encodes.
+void game_state_delta_apply(Game_State* state, const uint8_t* delta, size_t size);
+
+void rewind_init(Rewind_Ring* ring);
+
+/// Take a snapshot of `game_state`, dropping the oldest ones if needed.
+void rewind_push(Rewind_Ring* ring, const Game_State* game_state);
+
+/// How many snapshots are there to go back to.
+static inline int rewind_count(const Rewind_Ring* ring) {
+    return ring->count;
+}
+
+/// Restore the snapshot `ticks_back` before the newest one into `game_state`.
+/// Returns false if it is not in the ring (any more).
+bool rewind_restore(const Rewind_Ring* ring, int ticks_back, Game_State* game_state);
+
+/// Forget the newest snapshot and restore the one before it, which becomes the
+/// newest. Returns false if there is none.
+bool rewind_step_back(Rewind_Ring* ring, Game_State* game_state);
+
+/// fou_frame plus the rewind mode: holding left on the pause screen steps back
+/// a tick at a time, shoot resumes from there and back returns to the pause
+/// screen. Every tick played outside of the pause screen is pushed into `ring`.
+void rewind_frame(
+    Fou_Render_Target* target,
+    Rewind_Ring* ring,
+    Game_State* game_state,
+    Fou_User_Input_State current_frame_input,
+    Fou_User_Input_State prev_frame_input);
+
+#endif
@@ -0,0 +1,46 @@
+#include "sprite.h"
+#include "sprite_data.h"
+
+const Fou_Sprite* fou_sprite(Fou_Icon icon) {
+    return &sprites[icon];
+}
+
+static inline int max(int a, int b) {
+    return a > b ? a : b;
+}
+
+static inline int min(int a, int b) {
+    return a < b ? a : b;
+}
+
+bool fou_sprites_overlap(Fou_Icon a, int ax, int ay, Fou_Icon b, int bx, int by) {
+    const Fou_Sprite* sprite_a = &sprites[a];
+    const Fou_Sprite* sprite_b = &sprites[b];
+    int shift = bx - ax;
+    if (shift >= sprite_a->width || -shift >= sprite_b->width) return false;
+    int top = max(ay, by);
+    int bottom = min(ay + sprite_a->height, by + sprite_b->height);
+    for (int y = top; y < bottom; y++) {
+        uint32_t row_a = sprite_a->rows[y - ay];
+        uint32_t row_b = sprite_b->rows[y - by];
+        // line both rows up with the columns of the one further left
+        uint32_t both = shift >= 0 ? row_a & (row_b << shift) : (row_a << -shift) & row_b;
+        if (both != 0) return true;
+    }
+    return false;
+}
+
+bool fou_sprite_overlaps_rect(Fou_Icon icon, int x, int y, Rect rect) {
+    const Fou_Sprite* sprite = &sprites[icon];
+    int left = max(rect.x - x, 0);
+    int right = min(rect.x + rect.w - x, sprite->width);
+    if (left >= right) return false;
+    // the columns of `rect`, as a row of the sprite
+    uint32_t columns = ((1u << right) - 1) & ~((1u << left) - 1);
+    int top = max(y, rect.y);
+    int bottom = min(y + sprite->height, rect.y + rect.h);
+    for (int row = top; row < bottom; row++) {
+        if ((sprite->rows[row - y] & columns) != 0) return true;
+    }
+    return false;
+}
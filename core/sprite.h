@@ -0,0 +1,54 @@
+/*
+ * 1bpp bitmaps of the icons, generated from the PNGs in images/ by
+ * tools/gen_sprites.py. The app draws the firmware's own Icons, these are for
+ * everything that has to know the actual pixels.
+ *
+ * The same bitmaps are the collision masks. Collisions are tested in two
+ * steps: the boxes around the set pixels first, and only for boxes that
+ * overlap, the rows of both sprites, one shift and AND per row.
+ *
+ * Every sprite also comes with its outline already dilated, the pixels around
+ * it fou_draw_outlined_icon draws in the inverted color. Together with the
+ * sprite's rows, that is all a 1bpp target needs to draw an outlined icon in
+ * a single pass: outline and rows are the pixels that change, the rows the
+ * ones that end up in the current color.
+ */
+
+#ifndef SPRITE_H
+#define SPRITE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "flouhou.h"
+
+typedef struct {
+    uint8_t width;
+    uint8_t height;
+    // one entry per row, bit x is the pixel at column x, set pixels are drawn
+    const uint16_t* rows;
+    Rect opaque; // smallest box around the set pixels
+    // The icon whose shape the outline goes around, usually the sprite
+    // itself. The outline is what the four copies of it drawn one pixel to
+    // the left, right, top and bottom cover, outside of the set pixels.
+    uint8_t outlined_by; // Fou_Icon
+    // height + 2 rows from one pixel above the sprite, bit x is column x - 1
+    const uint32_t* outline;
+} Fou_Sprite;
+
+const Fou_Sprite* fou_sprite(Fou_Icon icon);
+
+/// The box around the set pixels of `icon` drawn at (x, y).
+static inline Rect fou_sprite_hitbox(Fou_Icon icon, int x, int y) {
+    Rect opaque = fou_sprite(icon)->opaque;
+    return (Rect){.x = x + opaque.x, .y = y + opaque.y, .w = opaque.w, .h = opaque.h};
+}
+
+/// Whether a set pixel of `a` drawn at (ax, ay) is on top of one of `b` drawn
+/// at (bx, by).
+bool fou_sprites_overlap(Fou_Icon a, int ax, int ay, Fou_Icon b, int bx, int by);
+
+/// Whether a set pixel of `icon` drawn at (x, y) is inside of `rect`.
+bool fou_sprite_overlaps_rect(Fou_Icon icon, int x, int y, Rect rect);
+
+#endif
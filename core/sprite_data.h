@@ -0,0 +1,122 @@
+/*
+ * Generated by tools/gen_sprites.py, do not edit.
+ */
+
+#ifndef SPRITE_DATA_H
+#define SPRITE_DATA_H
+
+#include "sprite.h"
+
+// BadFill_16x16.png
+static const uint16_t fou_icon_badfill_rows[16] = {
+    0x07e0, 0x1ff8, 0x3ffc, 0x7ffe, 0x7ffe, 0xffff, 0xffff, 0xffff,
+    0xffff, 0xffff, 0xffff, 0x7ffe, 0x7ffe, 0x3ffc, 0x1ff8, 0x07e0,
+};
+static const uint32_t fou_icon_badfill_outline[18] = {
+    0x00fc0, 0x03030, 0x04008, 0x08004, 0x10002, 0x10002, 0x20001, 0x20001,
+    0x20001, 0x20001, 0x20001, 0x20001, 0x10002, 0x10002, 0x08004, 0x04008,
+    0x03030, 0x00fc0,
+};
+
+// BadLaugh0_16x16.png
+static const uint16_t fou_icon_badlaugh0_rows[16] = {
+    0x07e0, 0x1ff8, 0x3ffc, 0x7ffe, 0x63fe, 0xc1e7, 0xffc3, 0xffff,
+    0xe7f3, 0xc3e3, 0xc063, 0x4022, 0x6026, 0x3c7c, 0x1ff8, 0x07e0,
+};
+static const uint32_t fou_icon_badlaugh0_outline[18] = {
+    0x00fc0, 0x03030, 0x04008, 0x08004, 0x10002, 0x13802, 0x27c31, 0x20079,
+    0x20001, 0x23019, 0x27839, 0x27f39, 0x17fba, 0x13fb2, 0x08704, 0x04008,
+    0x03030, 0x00fc0,
+};
+
+// BadLaugh1_16x16.png
+static const uint16_t fou_icon_badlaugh1_rows[16] = {
+    0x07e0, 0x1ff8, 0x3ffc, 0x67fe, 0x43e6, 0xfdc3, 0xffff, 0xe7f3,
+    0xc3e3, 0xc023, 0xc023, 0x6026, 0x702e, 0x383c, 0x1ff8, 0x07e0,
+};
+static const uint32_t fou_icon_badlaugh1_outline[18] = {
+    0x00fc0, 0x03030, 0x04008, 0x08004, 0x13002, 0x17832, 0x20479, 0x20001,
+    0x23019, 0x27839, 0x27fb9, 0x27fb9, 0x13fb2, 0x11fa2, 0x08f84, 0x04008,
+    0x03030, 0x00fc0,
+};
+
+// Bad0_16x16.png
+static const uint16_t fou_icon_bad0_rows[16] = {
+    0x07e0, 0x1ff8, 0x3ffc, 0x7ffe, 0x7ffe, 0xe7ff, 0xc3e7, 0xc1c3,
+    0xff83, 0xffff, 0xcff3, 0x40e2, 0x6066, 0x307c, 0x18f8, 0x07e0,
+};
+static const uint32_t fou_icon_bad0_outline[18] = {
+    0x00fc0, 0x03030, 0x04008, 0x08004, 0x10002, 0x10002, 0x23001, 0x27831,
+    0x27c79, 0x200f9, 0x20001, 0x26019, 0x17e3a, 0x13f32, 0x09f04, 0x04e08,
+    0x03030, 0x00fc0,
+};
+
+// Bad1_16x16.png
+static const uint16_t fou_icon_bad1_rows[16] = {
+    0x07e0, 0x1ff8, 0x3ffc, 0x7ffe, 0x67fe, 0xc3e7, 0xe1c3, 0xff87,
+    0xcfff, 0xc7f3, 0xc063, 0x4026, 0x6026, 0x302c, 0x1878, 0x07e0,
+};
+static const uint32_t fou_icon_bad1_outline[18] = {
+    0x00fc0, 0x03030, 0x04008, 0x08004, 0x10002, 0x13002, 0x27831, 0x23c79,
+    0x200f1, 0x26001, 0x27019, 0x27f39, 0x17fb2, 0x13fb2, 0x09fa4, 0x04f08,
+    0x03030, 0x00fc0,
+};
+
+// Shot_8x8.png
+static const uint16_t fou_icon_shot_rows[8] = {
+    0x0000, 0x0000, 0x0000, 0x007e, 0x007e, 0x0000, 0x0000, 0x0000,
+};
+static const uint32_t fou_icon_shot_outline[10] = {
+    0x00000, 0x00000, 0x00000, 0x000fc, 0x00102, 0x00102, 0x000fc, 0x00000,
+    0x00000, 0x00000,
+};
+
+// SpaceShip_8x8.png
+static const uint16_t fou_icon_spaceship_rows[8] = {
+    0x003c, 0x000e, 0x001f, 0x00fe, 0x00fe, 0x001f, 0x000e, 0x003c,
+};
+static const uint32_t fou_icon_spaceship_outline[10] = {
+    0x00078, 0x00084, 0x00062, 0x001c1, 0x00202, 0x00202, 0x001c1, 0x00062,
+    0x00084, 0x00078,
+};
+
+// BadPew_16x16.png
+static const uint16_t fou_icon_badpew_rows[8] = {
+    0x0018, 0x0018, 0x003c, 0x00ff, 0x00ff, 0x003c, 0x0018, 0x0018,
+};
+static const uint32_t fou_icon_badpew_outline[10] = {
+    0x00030, 0x00048, 0x00048, 0x00186, 0x00201, 0x00201, 0x00186, 0x00048,
+    0x00048, 0x00030,
+};
+
+// Heart_8x8.png
+static const uint16_t fou_icon_heart_rows[8] = {
+    0x0036, 0x007f, 0x007f, 0x007f, 0x003e, 0x001c, 0x0008, 0x0000,
+};
+static const uint32_t fou_icon_heart_outline[10] = {
+    0x0006c, 0x00092, 0x00101, 0x00101, 0x00101, 0x00082, 0x00044, 0x00028,
+    0x00010, 0x00000,
+};
+
+static const Fou_Sprite sprites[] = {
+    [FOU_ICON_BADFILL] = {16, 16, fou_icon_badfill_rows, {0, 0, 16, 16},
+        FOU_ICON_BADFILL, fou_icon_badfill_outline},
+    [FOU_ICON_BADLAUGH0] = {16, 16, fou_icon_badlaugh0_rows, {0, 0, 16, 16},
+        FOU_ICON_BADFILL, fou_icon_badlaugh0_outline},
+    [FOU_ICON_BADLAUGH1] = {16, 16, fou_icon_badlaugh1_rows, {0, 0, 16, 16},
+        FOU_ICON_BADFILL, fou_icon_badlaugh1_outline},
+    [FOU_ICON_BAD0] = {16, 16, fou_icon_bad0_rows, {0, 0, 16, 16},
+        FOU_ICON_BADFILL, fou_icon_bad0_outline},
+    [FOU_ICON_BAD1] = {16, 16, fou_icon_bad1_rows, {0, 0, 16, 16},
+        FOU_ICON_BADFILL, fou_icon_bad1_outline},
+    [FOU_ICON_SHOT] = {8, 8, fou_icon_shot_rows, {1, 3, 6, 2},
+        FOU_ICON_SHOT, fou_icon_shot_outline},
+    [FOU_ICON_SPACESHIP] = {8, 8, fou_icon_spaceship_rows, {0, 0, 8, 8},
+        FOU_ICON_SPACESHIP, fou_icon_spaceship_outline},
+    [FOU_ICON_BADPEW] = {8, 8, fou_icon_badpew_rows, {0, 0, 8, 8},
+        FOU_ICON_BADPEW, fou_icon_badpew_outline},
+    [FOU_ICON_HEART] = {8, 8, fou_icon_heart_rows, {0, 0, 7, 7},
+        FOU_ICON_HEART, fou_icon_heart_outline},
+};
+
+#endif
@@ -0,0 +1,26 @@
+#include "text.h"
+
+char* text_put_str(char* out, const char* string) {
+    while (*string != '\0') {
+        *out++ = *string++;
+    }
+    *out = '\0';
+    return out;
+}
+
+char* text_put_int(char* out, int32_t value) {
+    // digits come out last first, negating as unsigned also works for INT32_MIN
+    uint32_t left = value < 0 ? -(uint32_t)value : (uint32_t)value;
+    char digits[TEXT_INT_MAX_CHARS];
+    int count = 0;
+    do {
+        digits[count++] = '0' + left % 10;
+        left /= 10;
+    } while (left != 0);
+    if (value < 0) *out++ = '-';
+    while (count > 0) {
+        *out++ = digits[--count];
+    }
+    *out = '\0';
+    return out;
+}
@@ -0,0 +1,23 @@
+/*
+ * Building short strings for the HUD without snprintf: no format parsing, no
+ * locale, nothing on the heap, and none of the stack the firmware's printf
+ * needs.
+ *
+ * Every function writes at `out`, NUL terminates it and returns a pointer to
+ * the terminator, so calls chain. The caller makes sure everything fits.
+ */
+
+#ifndef TEXT_H
+#define TEXT_H
+
+#include <stdint.h>
+
+/// Most chars text_put_int writes, without the terminator.
+#define TEXT_INT_MAX_CHARS 11
+
+char* text_put_str(char* out, const char* string);
+
+/// `value` in decimal, with a minus sign if it is negative.
+char* text_put_int(char* out, int32_t value);
+
+#endif
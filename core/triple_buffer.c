@@ -0,0 +1,24 @@
+#include "triple_buffer.h"
+
+void triple_buffer_init(Triple_Buffer* triple) {
+    triple->writing = 0;
+    atomic_init(&triple->ready, 1);
+    triple->reading = 2;
+}
+
+unsigned int triple_buffer_publish(Triple_Buffer* triple) {
+    // whatever was ready before and not read yet is simply recycled
+    unsigned int previous = atomic_exchange_explicit(
+        &triple->ready, triple->writing | TRIPLE_BUFFER_FRESH, memory_order_acq_rel);
+    triple->writing = previous & ~TRIPLE_BUFFER_FRESH;
+    return triple->writing;
+}
+
+unsigned int triple_buffer_read(Triple_Buffer* triple) {
+    if (atomic_load_explicit(&triple->ready, memory_order_relaxed) & TRIPLE_BUFFER_FRESH) {
+        unsigned int previous =
+            atomic_exchange_explicit(&triple->ready, triple->reading, memory_order_acq_rel);
+        triple->reading = previous & ~TRIPLE_BUFFER_FRESH;
+    }
+    return triple->reading;
+}
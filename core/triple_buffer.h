@@ -0,0 +1,35 @@
+/*
+ * Index bookkeeping of a lock-free triple buffer, for handing frames from the
+ * game thread to the GUI thread.
+ *
+ * The writer always owns one of three slots, the reader always owns another
+ * one and the third one holds the latest finished frame. Handing a slot over
+ * is a single atomic exchange, neither side ever waits for the other.
+ */
+
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+#include <stdatomic.h>
+
+typedef struct {
+    // slot holding the latest finished frame, plus TRIPLE_BUFFER_FRESH if the
+    // reader has not taken it yet
+    atomic_uint ready;
+    unsigned int writing; // only touched by the writer
+    unsigned int reading; // only touched by the reader
+} Triple_Buffer;
+
+#define TRIPLE_BUFFER_FRESH 4u
+
+void triple_buffer_init(Triple_Buffer* triple);
+
+/// Hand the slot that was just written over to the reader. Returns the slot to
+/// write the next frame into.
+unsigned int triple_buffer_publish(Triple_Buffer* triple);
+
+/// The slot the reader should use: the latest published frame, or the one it
+/// already used last time if nothing new has been published since.
+unsigned int triple_buffer_read(Triple_Buffer* triple);
+
+#endif
@@ -1,23 +1,22 @@
-#include "core/mutex.h"
 #include "gui/canvas.h"
+#include <stdatomic.h>
 #include <stdint.h>
 #include <stdlib.h>
 
 #include <flouhou_icons.h>
+#include "core/dirty.h"
+#include "core/draw_list.h"
+#include "core/draw_opt.h"
+#include "core/fixed_step.h"
 #include "core/flouhou.h"
+#include "core/profile.h"
+#include "core/raster.h"
+#include "core/replay.h"
+#include "core/rewind.h"
+#include "core/sprite.h"
+#include "core/triple_buffer.h"
 #include <gui/gui.h>
-
-typedef enum {
-    DRAW_CALL_FOU_DRAW_BOX,
-    DRAW_CALL_FOU_DRAW_DISC,
-    DRAW_CALL_FOU_DRAW_DOT,
-    DRAW_CALL_FOU_DRAW_FRAME,
-    DRAW_CALL_FOU_DRAW_ICON,
-    DRAW_CALL_FOU_DRAW_STR,
-    DRAW_CALL_FOU_INVERT_COLOR,
-    DRAW_CALL_FOU_SET_BITMAP_MODE,
-    DRAW_CALL_FOU_SET_COLOR,
-} Draw_Call_Kind;
+#include <storage/storage.h>
 
 typedef enum {
     FOU_USERINPUT_UP,
@@ -36,6 +35,7 @@ typedef struct {
 typedef enum {
     FOUAPP_QUEUEEVENTKIND_TICK,
     FOUAPP_QUEUEEVENTKIND_INPUT,
+    FOUAPP_QUEUEEVENTKIND_TOGGLE_PROFILER, // long press of OK
 } Fouapp_Queue_Event_Kind;
 
 typedef struct {
@@ -43,145 +43,83 @@ typedef struct {
     Fouapp_Queue_Event_Input input;
 } Fouapp_Queue_Event;
 
-typedef struct {
-    Draw_Call_Kind kind;
-    union {
-        struct {int x; int y; int width; int height;} fou_draw_box;
-        struct {int x; int y; int radius;} fou_draw_disc;
-        struct {int x; int y;} fou_draw_dot;
-        struct {int x; int y; int width; int height;} fou_draw_frame;
-        struct {int x; int y; Fou_Icon icon;} fou_draw_icon;
-        struct {int x; int y; size_t string_idx;} fou_draw_str;
-        struct {;} fou_invert_color;
-        struct {bool alpha;} fou_set_bitmap_mode;
-        struct {bool color;} fou_set_color;
-    };
-} Draw_Call;
-
-struct {
-    Draw_Call* items;
-    size_t size;
-    size_t cap;
-} draw_calls = {0};
-
-struct {
-    char* items;
-    size_t size;
-    size_t cap;
-} draw_strings = {0};
-
-
-typedef struct {
-    FuriMessageQueue* message_queue;
-    FuriMutex* draw_call_mutex;
-} DrawCallbackData;
-
-
-#define MAX_DRAW_CALLS 128
-
-// maybe have `Draw_Call`s and `Draw_String`s live on the same arena in the future?
-
-void push_draw_call(Draw_Call draw_call) {
-    if (draw_calls.items == NULL) {
-        draw_calls.items = malloc(sizeof(Draw_Call) * MAX_DRAW_CALLS);
-    }
-    if (draw_calls.size != MAX_DRAW_CALLS) {
-        draw_calls.items[draw_calls.size++] = draw_call;
-    } else {
-        furi_check(false, "no more room for draw calls :(");
-    }
-}
-
-size_t push_draw_string(const char* string) {
-    int len = strlen(string) + 1;
-    size_t start_of_string = draw_strings.size;
-    while (draw_strings.cap < draw_strings.size + len) {
-        draw_strings.cap = 2 * (draw_strings.cap + 1);
-    }
-    draw_strings.items = realloc(draw_strings.items, sizeof(char) * draw_strings.cap);
-    furi_check(draw_strings.items != NULL);
-
-    memcpy(draw_strings.items + draw_strings.size, string, len - 1);
-    draw_strings.items[draw_strings.size + len - 1] = 0;
-    draw_strings.size += len;
-
-    return start_of_string;
-}
-
-void fou_draw_box(int x, int y, int width, int height) {
-    Draw_Call draw_call;
-    draw_call.kind = DRAW_CALL_FOU_DRAW_BOX;
-    draw_call.fou_draw_box.x = x;
-    draw_call.fou_draw_box.y = y;
-    draw_call.fou_draw_box.width = width;
-    draw_call.fou_draw_box.height = height;
-    push_draw_call(draw_call);
-}
-
-void fou_draw_disc(int x, int y, int radius) {
-    Draw_Call draw_call;
-    draw_call.kind = DRAW_CALL_FOU_DRAW_DISC;
-    draw_call.fou_draw_disc.x = x;
-    draw_call.fou_draw_disc.y = y;
-    draw_call.fou_draw_disc.radius = radius;
-    push_draw_call(draw_call);
-}
-
-void fou_draw_dot(int x, int y) {
-    Draw_Call draw_call;
-    draw_call.kind = DRAW_CALL_FOU_DRAW_DOT;
-    draw_call.fou_draw_disc.x = x;
-    draw_call.fou_draw_disc.y = y;
-    push_draw_call(draw_call);
-}
-
-void fou_draw_frame(int x, int y, int width, int height) {
-    Draw_Call draw_call;
-    draw_call.kind = DRAW_CALL_FOU_DRAW_FRAME;
-    draw_call.fou_draw_frame.x = x;
-    draw_call.fou_draw_frame.y = y;
-    draw_call.fou_draw_frame.width = width;
-    draw_call.fou_draw_frame.height = height;
-    push_draw_call(draw_call);
-}
-
-void fou_draw_icon(int x, int y, Fou_Icon icon) {
-    Draw_Call draw_call;
-    draw_call.kind = DRAW_CALL_FOU_DRAW_ICON;
-    draw_call.fou_draw_icon.x = x;
-    draw_call.fou_draw_icon.y = y;
-    draw_call.fou_draw_icon.icon = icon;
-    push_draw_call(draw_call);
-}
-
-void fou_draw_str(int x, int y, const char* string) {
-    Draw_Call draw_call;
-    draw_call.kind = DRAW_CALL_FOU_DRAW_STR;
-    draw_call.fou_draw_str.x = x;
-    draw_call.fou_draw_str.y = y;
-    draw_call.fou_draw_str.string_idx = push_draw_string(string);
-    push_draw_call(draw_call);
-}
-
-void fou_invert_color() {
-    Draw_Call draw_call;
-    draw_call.kind = DRAW_CALL_FOU_INVERT_COLOR;
-    push_draw_call(draw_call);
-}
-
-void fou_set_bitmap_mode(bool alpha) {
-    Draw_Call draw_call;
-    draw_call.kind = DRAW_CALL_FOU_SET_BITMAP_MODE;
-    draw_call.fou_set_bitmap_mode.alpha = alpha;
-    push_draw_call(draw_call);
-}
-
-void fou_set_color(bool color) {
-    Draw_Call draw_call;
-    draw_call.kind = DRAW_CALL_FOU_SET_COLOR;
-    draw_call.fou_set_color.color = color;
-    push_draw_call(draw_call);
-}
+#define TAG "flouhou"
+
+// 0: fou_frame records draw calls that the draw callback replays through the
+// canvas API.
+// 1: fou_frame rasterizes straight into a framebuffer that goes to the screen
+// in one canvas_draw_xbm, see core/raster.h.
+// 2: fou_frame records draw calls like with 0, the game loop rasterizes them
+// into a framebuffer like with 1, redrawing only the tiles that changed since
+// the previous frame.
+// Whatever the backend, a frame that looks exactly like the previous one is
+// neither handed to the GUI thread nor does it update the view port.
+#ifndef FOU_RASTER_BACKEND
+#define FOU_RASTER_BACKEND 0
+#endif
+#define FOU_RECORDS_DRAW_LISTS (FOU_RASTER_BACKEND != 1)
+#define FOU_SHOWS_RASTERS (FOU_RASTER_BACKEND != 0)
+
+// The simulation runs at a fixed FOU_TICK_RATE ticks per second, catching up on
+// at most FOU_MAX_CATCH_UP_TICKS at once when it fell behind. Frames are drawn
+// FOU_RENDER_RATE times per second, interpolated between the last two ticks.
+#ifndef FOU_TICK_RATE
+#define FOU_TICK_RATE 16
+#endif
+#ifndef FOU_RENDER_RATE
+#define FOU_RENDER_RATE 32
+#endif
+#ifndef FOU_MAX_CATCH_UP_TICKS
+#define FOU_MAX_CATCH_UP_TICKS 4
+#endif
+
+// 0: input comes from the buttons only.
+// 1: the input of every tick is recorded to FOU_REPLAY_PATH, see core/replay.h.
+// 2: FOU_REPLAY_PATH is played back first, FOU_REPLAY_SPEED recorded ticks for
+// every simulated one, then the buttons take over. Back stops the playback early.
+#ifndef FOU_REPLAY
+#define FOU_REPLAY 1
+#endif
+#ifndef FOU_REPLAY_PATH
+#define FOU_REPLAY_PATH EXT_PATH("apps_data/flouhou/last.fourep")
+#endif
+#ifndef FOU_REPLAY_SPEED
+#define FOU_REPLAY_SPEED 1
+#endif
+
+#ifndef FOU_PROFILE_PATH
+#define FOU_PROFILE_PATH EXT_PATH("apps_data/flouhou/profile.foup")
+#endif
+
+#if FOU_SHOWS_RASTERS
+// Written by the game loop, read by the GUI thread in `my_raster_draw_callback`.
+Raster rasters[3];
+Triple_Buffer raster_buffer;
+#endif
+
+#if FOU_RASTER_BACKEND == 1
+
+// The framebuffer fou_frame is currently drawing into.
+Raster* recording_raster = NULL;
+// The framebuffer handed to the GUI thread last.
+const Raster* published_raster = NULL;
+
+#else
+
+#if FOU_RASTER_BACKEND == 0
+// Written by the game loop, read by the GUI thread in `my_draw_callback`.
+Draw_List_Triple draw_lists;
+#else
+// Only ever touched by the game loop.
+Draw_List frame_draw_list;
+// The previous frame, kept to redraw only what changed.
+Raster frame_raster;
+#endif
+
+// The list fou_frame is currently recording into.
+Draw_List* recording_draw_list = NULL;
+
+#endif
 
 const Icon* icon_enum_to_actual_icon(Fou_Icon icon) {
     switch (icon) {
@@ -198,19 +136,70 @@ const Icon* icon_enum_to_actual_icon(Fou_Icon icon) {
     furi_check(false);
 }
 
+/// See FOU_STR_OUTLINED, draws with the canvas' color and inverts it back.
+static void canvas_draw_outlined_str(Canvas* canvas, int x, int y, const char* string) {
+    canvas_draw_str(canvas, x - 1, y, string);
+    canvas_draw_str(canvas, x + 1, y, string);
+    canvas_draw_str(canvas, x, y - 1, string);
+    canvas_draw_str(canvas, x, y + 1, string);
+    canvas_invert_color(canvas);
+    canvas_draw_str(canvas, x, y, string);
+    canvas_invert_color(canvas);
+}
+
+#if FOU_SHOWS_RASTERS
+
+static void my_raster_draw_callback(Canvas* canvas, void* context) {
+    Triple_Buffer* buffer = context;
+
+    if (canvas == NULL) {
+        return;
+    }
+
+    PROFILE_BEGIN(REPLAY);
+    const Raster* raster = &rasters[triple_buffer_read(buffer)];
+    canvas_set_bitmap_mode(canvas, false);
+    canvas_set_color(canvas, ColorBlack);
+    canvas_draw_xbm(canvas, 0, 0, RASTER_WIDTH, RASTER_HEIGHT, (const uint8_t*)raster->pixels);
+    for (int i = 0; i < raster->text_count; i++) {
+        const Raster_Text* text = &raster->texts[i];
+        canvas_set_color(canvas, text->color);
+        if (text->outlined) {
+            canvas_draw_outlined_str(canvas, text->x, text->y, raster_text_string(raster, text));
+        } else {
+            canvas_draw_str(canvas, text->x, text->y, raster_text_string(raster, text));
+        }
+    }
+    PROFILE_END(REPLAY);
+}
+
+#else
+
+/// See fou_draw_outlined_icon, the canvas only has whole icons to draw it with.
+static void canvas_draw_outlined_icon(Canvas* canvas, int x, int y, Fou_Icon icon) {
+    const Icon* outlined_by = icon_enum_to_actual_icon(fou_sprite(icon)->outlined_by);
+    canvas_invert_color(canvas);
+    canvas_draw_icon(canvas, x - 1, y, outlined_by);
+    canvas_draw_icon(canvas, x + 1, y, outlined_by);
+    canvas_draw_icon(canvas, x, y - 1, outlined_by);
+    canvas_draw_icon(canvas, x, y + 1, outlined_by);
+    canvas_invert_color(canvas);
+    canvas_draw_icon(canvas, x, y, icon_enum_to_actual_icon(icon));
+}
+
 static void my_draw_callback(Canvas* canvas, void* context) {
-    FuriMutex* draw_call_mutex = context;
+    Draw_List_Triple* triple = context;
 
     if (canvas == NULL) {
         return;
     }
 
-    furi_check(
-        furi_mutex_acquire(draw_call_mutex, 0) == FuriStatusOk,
-        "could not aquire mutex"
-    );
-    for (size_t i = 0; i < draw_calls.size; i++) {
-        Draw_Call dc = draw_calls.items[i];
+    PROFILE_BEGIN(REPLAY);
+    // Never blocks: this is either the latest frame the game loop published
+    // or the same frame as last time.
+    const Draw_List* draw_list = draw_list_triple_read(triple);
+    for (size_t i = 0; i < draw_list->calls.size; i++) {
+        Draw_Call dc = draw_list->calls.items[i];
         switch (dc.kind) {
             case DRAW_CALL_FOU_DRAW_BOX:
                 canvas_draw_box(
@@ -253,12 +242,28 @@ static void my_draw_callback(Canvas* canvas, void* context) {
                     icon_enum_to_actual_icon(dc.fou_draw_icon.icon)
                 );
             break;
+            case DRAW_CALL_FOU_DRAW_OUTLINED_ICON:
+                canvas_draw_outlined_icon(
+                    canvas,
+                    dc.fou_draw_icon.x,
+                    dc.fou_draw_icon.y,
+                    dc.fou_draw_icon.icon
+                );
+            break;
             case DRAW_CALL_FOU_DRAW_STR:
                 canvas_draw_str(
                     canvas,
                     dc.fou_draw_str.x,
                     dc.fou_draw_str.y,
-                    &draw_strings.items[dc.fou_draw_str.string_idx]
+                    dc.fou_draw_str.string
+                );
+            break;
+            case DRAW_CALL_FOU_DRAW_OUTLINED_STR:
+                canvas_draw_outlined_str(
+                    canvas,
+                    dc.fou_draw_str.x,
+                    dc.fou_draw_str.y,
+                    dc.fou_draw_str.string
                 );
             break;
             case DRAW_CALL_FOU_INVERT_COLOR:
@@ -272,18 +277,22 @@ static void my_draw_callback(Canvas* canvas, void* context) {
             break;
         }
     }
-
-    furi_check(
-        furi_mutex_release(draw_call_mutex) == FuriStatusOk,
-        "could not release mutex"
-    );
+    PROFILE_END(REPLAY);
 }
 
+#endif
+
 static void my_input_callback(InputEvent* inputevent, void* context) {
     FuriMessageQueue** queue = context;
     if (inputevent == NULL) {
         return;
     }
+    if (inputevent->type == InputTypeLong && inputevent->key == InputKeyOk) {
+        // the press itself already went out as a shot
+        Fouapp_Queue_Event event = {.kind = FOUAPP_QUEUEEVENTKIND_TOGGLE_PROFILER};
+        furi_message_queue_put(*queue, &event, FuriWaitForever);
+        return;
+    }
     Fouapp_Queue_Event_Input event_input = {0};
     if (inputevent->type == InputTypeRelease) {
         event_input.pressed = false;
@@ -320,14 +329,148 @@ static void my_input_callback(InputEvent* inputevent, void* context) {
     }
 }
 
+// Set while a TICK event waits in the queue. The timer never queues a second
+// one nor waits for room in the queue, the fixed step catches up on however
+// much time passed when the event is finally handled.
+static atomic_bool tick_queued;
+
 static void my_timer_callback(void* context) {
     FuriMessageQueue** msg_queue = context;
+    if (atomic_exchange(&tick_queued, true)) {
+        return;
+    }
     Fouapp_Queue_Event event = {
         .kind = FOUAPP_QUEUEEVENTKIND_TICK,
     };
-    furi_message_queue_put(*msg_queue, &event, FuriWaitForever);
+    if (furi_message_queue_put(*msg_queue, &event, 0) != FuriStatusOk) {
+        atomic_store(&tick_queued, false);
+    }
 }; 
 
+// While nothing on the screen can change without input, the timer is stopped
+// and the game loop only wakes up for the input queue.
+typedef enum {
+    FOUAPP_POWER_RUNNING,
+    FOUAPP_POWER_IDLE,
+} Fouapp_Power_State;
+
+/// Whether the game loop can stop ticking until the next input: the pause and
+/// rewind screens are already on the screen and no button is held.
+static bool can_idle(
+    const Game_State* game_state,
+    const Game_State* previous_game_state,
+    Fou_User_Input_State input)
+{
+    // the last tick started paused, it drew the pause or rewind screen
+    return game_state->paused && previous_game_state->paused && !input.up && !input.down &&
+           !input.left && !input.right && !input.back && !input.shoot;
+}
+
+/// Wakeups of the game loop, logged about once a minute to see what idling
+/// saves.
+typedef struct {
+    uint32_t clock_hz;
+    uint32_t window_start; // clock time the current count started at
+    uint32_t count;
+    unsigned long total;
+} Wakeup_Counter;
+
+static void wakeup_count(Wakeup_Counter* counter, uint32_t now) {
+    counter->count++;
+    counter->total++;
+    uint32_t elapsed = now - counter->window_start;
+    if (elapsed < 60 * counter->clock_hz) return;
+    // idle minutes have no wakeup of their own to log them, they are averaged
+    // in with the next one
+    FURI_LOG_I(
+        TAG,
+        "%lu wakeups per minute",
+        (unsigned long)((uint64_t)counter->count * 60 * counter->clock_hz / elapsed));
+    counter->window_start = now;
+    counter->count = 0;
+}
+
+
+/// Throw away whatever the frame just run drew.
+static void discard_frame(void) {
+#if FOU_RASTER_BACKEND == 1
+    raster_clear(recording_raster);
+#else
+    draw_list_clear(recording_draw_list);
+#endif
+}
+
+#if FOU_PROFILE
+static void write_trace_chunk(void* context, const void* data, size_t size) {
+    storage_file_write(context, data, size);
+}
+
+/// Keep the last samples of every phase around to look at with
+/// tools/profile_summary.py.
+static void save_profile_trace(Storage* storage) {
+    File* file = storage_file_alloc(storage);
+    storage_simply_mkdir(storage, EXT_PATH("apps_data"));
+    storage_simply_mkdir(storage, EXT_PATH("apps_data/flouhou"));
+    if (storage_file_open(file, FOU_PROFILE_PATH, FSAM_WRITE, FSOM_CREATE_ALWAYS)) {
+        size_t size = profile_trace_write(&fou_profiler, write_trace_chunk, file);
+        storage_file_close(file);
+        FURI_LOG_I(TAG, "wrote %u bytes of profiler trace", (unsigned)size);
+    } else {
+        FURI_LOG_E(TAG, "could not create %s", FOU_PROFILE_PATH);
+    }
+    storage_file_free(file);
+}
+#endif
+
+#if FOU_REPLAY == 1
+
+#define REPLAY_WRITER_FLAG_BLOCK (1 << 0) // the recorder handed over a block
+#define REPLAY_WRITER_FLAG_STOP (1 << 1)
+
+typedef struct {
+    Replay_Recorder recorder;
+    File* file;
+    size_t bytes_written;
+} Replay_Writer;
+
+/// Writes the blocks the game loop hands over, so it never waits for the SD
+/// card.
+static int32_t replay_writer_thread(void* context) {
+    Replay_Writer* writer = context;
+    for (;;) {
+        uint32_t flags = furi_thread_flags_wait(
+            REPLAY_WRITER_FLAG_BLOCK | REPLAY_WRITER_FLAG_STOP, FuriFlagWaitAny, FuriWaitForever);
+        if (flags & FuriFlagError) continue;
+        const Replay_Block* block = replay_recorder_full_block(&writer->recorder);
+        if (block != NULL) {
+            writer->bytes_written += storage_file_write(writer->file, block->bytes, block->size);
+            replay_recorder_block_written(&writer->recorder);
+        }
+        if (flags & REPLAY_WRITER_FLAG_STOP) break;
+    }
+    return 0;
+}
+
+#elif FOU_REPLAY == 2
+
+/// Reads the whole replay into a malloc'd buffer, NULL if there is none.
+static uint8_t* load_replay(Storage* storage, size_t* size) {
+    File* file = storage_file_alloc(storage);
+    uint8_t* data = NULL;
+    if (storage_file_open(file, FOU_REPLAY_PATH, FSAM_READ, FSOM_OPEN_EXISTING)) {
+        *size = storage_file_size(file);
+        data = malloc(*size);
+        if (data != NULL && storage_file_read(file, data, *size) != *size) {
+            free(data);
+            data = NULL;
+        }
+        storage_file_close(file);
+    }
+    storage_file_free(file);
+    return data;
+}
+
+#endif
 
 int32_t flouhou_app(void* p) {
     (void)(p);
@@ -337,21 +480,110 @@ int32_t flouhou_app(void* p) {
     Game_State* game_state = malloc(sizeof(Game_State));
     assert(game_state);
     *game_state = fou_init_game_state();
-
-
-    FuriMutex* draw_call_mutex = furi_mutex_alloc(FuriMutexTypeNormal);
+    // the state before the last tick, to interpolate between
+    Game_State* previous_game_state = malloc(sizeof(Game_State));
+    furi_check(previous_game_state, "failed to allocate game state");
+    *previous_game_state = *game_state;
+    // the last few seconds of play, for the rewind mode
+    Rewind_Ring* rewind_ring = malloc(sizeof(Rewind_Ring));
+    furi_check(rewind_ring, "failed to allocate rewind ring");
+    rewind_init(rewind_ring);
+
+
+#if FOU_SHOWS_RASTERS
+    triple_buffer_init(&raster_buffer);
+    for (int i = 0; i < 3; i++) {
+        raster_clear(&rasters[i]);
+    }
+#endif
+#if FOU_RASTER_BACKEND == 0
+    draw_list_triple_init(&draw_lists);
+#elif FOU_RASTER_BACKEND == 1
+    recording_raster = &rasters[raster_buffer.writing];
+#else
+    draw_list_init(&frame_draw_list);
+    recording_draw_list = &frame_draw_list;
+    raster_clear(&frame_raster);
+#endif
+#if FOU_RECORDS_DRAW_LISTS
+    // scratch space of the peephole pass and the dirty tracker, also too big
+    // for the stack
+    Draw_Optimizer* draw_optimizer = malloc(sizeof(Draw_Optimizer));
+    furi_check(draw_optimizer, "failed to allocate draw optimizer");
+    Dirty_Tracker* dirty_tracker = malloc(sizeof(Dirty_Tracker));
+    furi_check(dirty_tracker, "failed to allocate dirty tracker");
+    dirty_tracker_reset(dirty_tracker);
+#endif
+    // One target for the whole run, it keeps the HUD strings between frames.
+    // Only its context follows the buffer being recorded.
+#if FOU_RASTER_BACKEND == 1
+    Fou_Render_Target target = raster_render_target(recording_raster);
+#else
+    Fou_Render_Target target = draw_list_render_target(recording_draw_list);
+#endif
+    uint32_t frames_shown = 0;
+    uint32_t frames_unchanged = 0;
+    profile_init(&fou_profiler);
+    bool profile_hud = false;
+
+#if FOU_REPLAY || FOU_PROFILE
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    furi_check(storage, "could not open furi record (RECORD_STORAGE)");
+#endif
+#if FOU_REPLAY == 1
+    // Nothing is recorded if the file cannot be created, the game still runs.
+    Replay_Writer* replay_writer = malloc(sizeof(Replay_Writer));
+    furi_check(replay_writer, "failed to allocate replay writer");
+    replay_recorder_init(&replay_writer->recorder);
+    replay_writer->bytes_written = 0;
+    replay_writer->file = storage_file_alloc(storage);
+    storage_simply_mkdir(storage, EXT_PATH("apps_data"));
+    storage_simply_mkdir(storage, EXT_PATH("apps_data/flouhou"));
+    bool recording = storage_file_open(
+        replay_writer->file, FOU_REPLAY_PATH, FSAM_WRITE, FSOM_CREATE_ALWAYS);
+    FuriThread* replay_thread = NULL;
+    if (recording) {
+        replay_thread =
+            furi_thread_alloc_ex("FlouhouReplay", 1024, replay_writer_thread, replay_writer);
+        furi_thread_start(replay_thread);
+    } else {
+        FURI_LOG_E(TAG, "could not create %s, not recording", FOU_REPLAY_PATH);
+    }
+#elif FOU_REPLAY == 2
+    size_t replay_size = 0;
+    uint8_t* replay_data = load_replay(storage, &replay_size);
+    Replay_Player replay_player;
+    bool replaying = replay_data != NULL &&
+                     replay_player_init(&replay_player, replay_data, replay_size);
+    if (!replaying) {
+        FURI_LOG_E(TAG, "could not load a replay from %s", FOU_REPLAY_PATH);
+    }
+#endif
     FuriMessageQueue* queue = furi_message_queue_alloc(16, sizeof(Fouapp_Queue_Event));
     furi_check(queue != NULL, "failed to allocate message queue");
     ViewPort* my_view_port = view_port_alloc();
 
+    // The timer wakes the game loop up to draw a frame, the fixed step decides
+    // how many ticks to simulate before that.
+    Fixed_Step fixed_step;
+    fixed_step_init(
+        &fixed_step,
+        furi_kernel_get_tick_frequency(),
+        FOU_TICK_RATE,
+        FOU_MAX_CATCH_UP_TICKS,
+        furi_get_tick());
+    atomic_init(&tick_queued, false);
     FuriTimer* timer = furi_timer_alloc(my_timer_callback, FuriTimerTypePeriodic, (void*)&queue);
     furi_check(queue != NULL, "failed to allocate timer");
-    uint32_t tick_phase = furi_kernel_get_tick_frequency() / 16;
+    uint32_t tick_phase = furi_kernel_get_tick_frequency() / FOU_RENDER_RATE;
     furi_check(tick_phase > 0);
-    // uint32_t tick_phase = furi_ms_to_ticks(16);
     furi_check(furi_timer_start(timer, tick_phase) == FuriStatusOk, "failed to set timer");
 
-    view_port_draw_callback_set(my_view_port, my_draw_callback, (void*)draw_call_mutex);
+#if FOU_SHOWS_RASTERS
+    view_port_draw_callback_set(my_view_port, my_raster_draw_callback, (void*)&raster_buffer);
+#else
+    view_port_draw_callback_set(my_view_port, my_draw_callback, (void*)&draw_lists);
+#endif
     view_port_input_callback_set(my_view_port, my_input_callback, (void*)&queue);
 
     Gui* gui = furi_record_open(RECORD_GUI);
@@ -365,6 +597,11 @@ int32_t flouhou_app(void* p) {
 
     Fouapp_Queue_Event event;
     bool should_quit = false;
+    Fouapp_Power_State power_state = FOUAPP_POWER_RUNNING;
+    Wakeup_Counter wakeups = {
+        .clock_hz = furi_kernel_get_tick_frequency(),
+        .window_start = furi_get_tick(),
+    };
 
     while(!should_quit) {
 
@@ -372,29 +609,146 @@ int32_t flouhou_app(void* p) {
         if (status != FuriStatusOk) {
             break;
         }
+        wakeup_count(&wakeups, furi_get_tick());
+
+        if (power_state == FOUAPP_POWER_IDLE && event.kind != FOUAPP_QUEUEEVENTKIND_TICK) {
+            // tick once right away for the input, then at the usual rate
+            power_state = FOUAPP_POWER_RUNNING;
+            fixed_step_resume(&fixed_step, furi_get_tick());
+            furi_check(furi_timer_start(timer, tick_phase) == FuriStatusOk, "failed to set timer");
+            my_timer_callback(&queue);
+        }
 
         switch(event.kind) {
         case FOUAPP_QUEUEEVENTKIND_TICK: {
-            furi_check(furi_mutex_acquire(draw_call_mutex, FuriWaitForever) == FuriStatusOk);
-            draw_calls.size = 0;
-            draw_strings.size = 0;
-            fou_frame(game_state, current_frame_input, previous_frame_input);
-            furi_check(furi_mutex_release(draw_call_mutex) == FuriStatusOk);
-            view_port_update(my_view_port);
-            if (game_state->should_quit) {
-                should_quit = true;
+            atomic_store(&tick_queued, false);
+            // queued before the timer was stopped
+            if (power_state == FOUAPP_POWER_IDLE) break;
+#if FOU_RASTER_BACKEND == 0
+            recording_draw_list = draw_list_triple_writing(&draw_lists);
+#endif
+#if FOU_RASTER_BACKEND == 1
+            target.context = recording_raster;
+#else
+            target.context = recording_draw_list;
+#endif
+            int due = fixed_step_advance(&fixed_step, furi_get_tick());
+            for (int step = 0; step < due && !should_quit; step++) {
+                *previous_game_state = *game_state;
+                // only what the last tick draws can end up on the screen
+                discard_frame();
+#if FOU_REPLAY == 1
+                if (recording &&
+                    replay_recorder_tick(&replay_writer->recorder, current_frame_input)) {
+                    furi_thread_flags_set(
+                        furi_thread_get_id(replay_thread), REPLAY_WRITER_FLAG_BLOCK);
+                }
+#elif FOU_REPLAY == 2
+                if (replaying) {
+                    for (int i = 1; i < FOU_REPLAY_SPEED; i++) {
+                        if (!replay_player_next(&replay_player, &current_frame_input)) break;
+                        rewind_frame(
+                            &target,
+                            rewind_ring,
+                            game_state,
+                            current_frame_input,
+                            previous_frame_input);
+                        discard_frame();
+                        previous_frame_input = current_frame_input;
+                    }
+                    replaying = replay_player_next(&replay_player, &current_frame_input);
+                    if (!replaying) {
+                        FURI_LOG_I(
+                            TAG,
+                            "replay ended after %lu ticks",
+                            (unsigned long)replay_player.ticks);
+                        current_frame_input = (Fou_User_Input_State){0};
+                    }
+                }
+#endif
+                rewind_frame(
+                    &target, rewind_ring, game_state, current_frame_input, previous_frame_input);
+                if (game_state->should_quit) {
+                    should_quit = true;
+                }
+                previous_frame_input = current_frame_input;
+                if (released_keys.up) current_frame_input.up = false;
+                if (released_keys.down) current_frame_input.down = false;
+                if (released_keys.left) current_frame_input.left = false;
+                if (released_keys.right) current_frame_input.right = false;
+                if (released_keys.back) current_frame_input.back = false;
+                if (released_keys.shoot) current_frame_input.shoot = false;
+                released_keys = (Fou_User_Input_State){0};
+            }
+
+            // The pause and rewind screens are only drawn by the tick itself
+            // and do not move in between ticks.
+            bool interpolate = !game_state->paused && !rewind_ring->rewinding;
+            if (due == 0 && !interpolate) {
+                frames_unchanged++;
+                break;
+            }
+            if (interpolate) {
+                discard_frame();
+                fou_draw_game_interpolated(
+                    &target,
+                    previous_game_state, game_state, fixed_step_alpha(&fixed_step));
+            }
+
+            if (profile_hud) {
+                profile_draw_hud(&target, &fou_profiler);
+            }
+
+            bool changed;
+#if FOU_RASTER_BACKEND == 1
+            // Only ever read once published, whichever thread owns it now. The
+            // first frame has nothing to compare with.
+            changed = !published_raster || !raster_equal(recording_raster, published_raster);
+            if (changed) {
+                published_raster = recording_raster;
+                recording_raster = &rasters[triple_buffer_publish(&raster_buffer)];
+            }
+#else
+            draw_list_optimize(draw_optimizer, recording_draw_list);
+            uint32_t dirty_tiles = dirty_tracker_update(dirty_tracker, recording_draw_list);
+            changed = dirty_tiles != 0;
+#if FOU_RASTER_BACKEND == 0
+            if (changed) {
+                draw_list_triple_publish(&draw_lists);
+            }
+#else
+            if (changed) {
+                raster_draw_list_tiles(
+                    &frame_raster, recording_draw_list, dirty_tiles, dirty_tracker->call_tiles);
+                rasters[raster_buffer.writing] = frame_raster;
+                triple_buffer_publish(&raster_buffer);
             }
-            previous_frame_input = current_frame_input;
-            if (released_keys.up) current_frame_input.up = false;
-            if (released_keys.down) current_frame_input.down = false;
-            if (released_keys.left) current_frame_input.left = false;
-            if (released_keys.right) current_frame_input.right = false;
-            if (released_keys.back) current_frame_input.back = false;
-            if (released_keys.shoot) current_frame_input.shoot = false;
-            released_keys = (Fou_User_Input_State){0};
+#endif
+#endif
+            if (changed) {
+                view_port_update(my_view_port);
+                frames_shown++;
+            } else {
+                frames_unchanged++;
+            }
+        } break;
+
+        case FOUAPP_QUEUEEVENTKIND_TOGGLE_PROFILER: {
+            // shows up with the next frame drawn
+            profile_hud = !profile_hud;
         } break;
 
         case FOUAPP_QUEUEEVENTKIND_INPUT: {
+#if FOU_REPLAY == 2
+            // the buttons do nothing during playback but stop it
+            if (replaying) {
+                if (event.input.user_input == FOU_USERINPUT_BACK && event.input.pressed) {
+                    replaying = false;
+                    current_frame_input = (Fou_User_Input_State){0};
+                }
+                break;
+            }
+#endif
             // We could simply mark each button as 'pressed' or 'not pressed'
             // as soon as the user presses or releases the button. But that
             // means that if the user presses and releases the same button
@@ -451,8 +805,82 @@ int32_t flouhou_app(void* p) {
             }
         } break;
         }
+
+        bool idle = power_state == FOUAPP_POWER_RUNNING &&
+                    event.kind == FOUAPP_QUEUEEVENTKIND_TICK &&
+                    can_idle(game_state, previous_game_state, current_frame_input);
+#if FOU_REPLAY == 2
+        // the replay is the input
+        idle = idle && !replaying;
+#endif
+        if (idle) {
+            // Ticks without input while paused change nothing, a recorded
+            // replay plays back the same without them.
+            power_state = FOUAPP_POWER_IDLE;
+            furi_timer_stop(timer);
+        }
      }
 
+    FURI_LOG_I(
+        TAG,
+        "%lu frames shown, %lu unchanged and skipped",
+        (unsigned long)frames_shown,
+        (unsigned long)frames_unchanged);
+    FURI_LOG_I(
+        TAG,
+        "%lu ticks simulated, %lu dropped to catch up",
+        fixed_step.ticks,
+        fixed_step.ticks_dropped);
+    FURI_LOG_I(TAG, "%lu wakeups of the game loop", wakeups.total);
+#if FOU_RECORDS_DRAW_LISTS
+    // numbers to size DRAW_LIST_ARENA_SIZE with
+#if FOU_RASTER_BACKEND == 0
+    Draw_List_Stats draw_stats = draw_list_triple_stats(&draw_lists);
+#else
+    Draw_List_Stats draw_stats = frame_draw_list.stats;
+#endif
+    FURI_LOG_I(
+        TAG,
+        "draw list peak %u of %u bytes (%u calls, %u string bytes), dropped %lu low, %lu normal",
+        (unsigned)draw_stats.peak_bytes,
+        (unsigned)DRAW_LIST_ARENA_SIZE,
+        (unsigned)draw_stats.peak_calls,
+        (unsigned)draw_stats.peak_string_bytes,
+        draw_stats.dropped_low,
+        draw_stats.dropped_normal);
+#endif
+
+#if FOU_REPLAY == 1
+    if (recording) {
+        // the writer takes care of any full block before it stops
+        furi_thread_flags_set(furi_thread_get_id(replay_thread), REPLAY_WRITER_FLAG_STOP);
+        furi_thread_join(replay_thread);
+        furi_thread_free(replay_thread);
+        const Replay_Block* tail = replay_recorder_finish(&replay_writer->recorder);
+        replay_writer->bytes_written +=
+            storage_file_write(replay_writer->file, tail->bytes, tail->size);
+        storage_file_close(replay_writer->file);
+        FURI_LOG_I(
+            TAG,
+            "recorded %lu ticks of input in %u bytes%s",
+            (unsigned long)replay_writer->recorder.ticks,
+            (unsigned)replay_writer->bytes_written,
+            replay_writer->recorder.overflowed ? ", cut short, the SD card fell behind" : "");
+    }
+    storage_file_free(replay_writer->file);
+    free(replay_writer);
+#elif FOU_REPLAY == 2
+    free(replay_data);
+#endif
+#if FOU_PROFILE
+    save_profile_trace(storage);
+#endif
+#if FOU_REPLAY || FOU_PROFILE
+    furi_record_close(RECORD_STORAGE);
+#endif
+
+    free(rewind_ring);
+    free(previous_game_state);
     free(game_state);
     furi_message_queue_free(queue);
 
@@ -462,6 +890,16 @@ int32_t flouhou_app(void* p) {
     gui_remove_view_port(gui, my_view_port);
     view_port_enabled_set(my_view_port, false);
     view_port_free(my_view_port);
+    // the draw callback can no longer run, so the lists can go
+#if FOU_RASTER_BACKEND == 0
+    draw_list_triple_free(&draw_lists);
+#elif FOU_RASTER_BACKEND == 2
+    draw_list_free(&frame_draw_list);
+#endif
+#if FOU_RECORDS_DRAW_LISTS
+    free(draw_optimizer);
+    free(dirty_tracker);
+#endif
 
     furi_record_close(RECORD_GUI);
 
@@ -0,0 +1,30 @@
+/*
+ * Host stand-in for the furi <core/check.h> header so core/ can be built and
+ * benchmarked on a desktop machine.
+ */
+
+#ifndef HOST_CORE_CHECK_H
+#define HOST_CORE_CHECK_H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static inline void furi_host_crash(const char* message, const char* file, int line) {
+    fprintf(stderr, "%s:%d: %s\n", file, line, message);
+    abort();
+}
+
+// Same as on device: the message argument is optional.
+#define FURI_HOST_CHECK(expr, message, ...) \
+    ((expr) ? (void)0 : furi_host_crash(message, __FILE__, __LINE__))
+
+#define furi_check(...) FURI_HOST_CHECK(__VA_ARGS__, "furi_check failed", 0)
+
+// furi only evaluates asserts in debug builds, so do the same here.
+#ifdef FURI_DEBUG
+#define furi_assert(...) FURI_HOST_CHECK(__VA_ARGS__, "furi_assert failed", 0)
+#else
+#define furi_assert(...) do {} while (0)
+#endif
+
+#endif
@@ -0,0 +1,812 @@
+/*
+ * Deterministic benchmark runner for fou_frame.
+ *
+ * Every scenario drives a fresh Game_State through a fixed, looping input
+ * script. Some scenarios additionally poke the game state before each tick to
+ * hold it in an interesting configuration (full bullet arrays, constant
+ * deaths, ...). Nothing here depends on wall clock time or unseeded
+ * randomness, so two runs of the same build simulate exactly the same ticks
+ * and only the measured timings differ.
+ */
+
+#include <limits.h>
+#include <pthread.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "core/dirty.h"
+#include "core/draw_opt.h"
+#include "core/flouhou.h"
+#include "core/profile.h"
+#include "core/raster.h"
+#include "core/replay.h"
+#include "core/rewind.h"
+#include "host_draw.h"
+
+#define DEFAULT_TICKS 100000
+
+// -d: where to write the last frame of every scenario to, as <prefix><name>.pbm
+static const char* dump_prefix = NULL;
+// -r: where to record the input of every scenario to, as <prefix><name>.fourep
+static const char* record_prefix = NULL;
+// -t: where to write the profiler trace of every scenario to, as <prefix><name>.foup
+static const char* trace_prefix = NULL;
+
+typedef struct {
+    int ticks; // how long the step is held
+    bool up;
+    bool down;
+    bool left;
+    bool right;
+    bool shoot;
+} Script_Step;
+
+typedef struct {
+    const char* name;
+    const char* description;
+    const Script_Step* script;
+    int script_len;
+    /// Called before every tick, may be NULL.
+    void (*prepare)(Game_State* game_state, int tick);
+} Scenario;
+
+/// Small LCG so the scenarios are reproducible across platforms and libcs. One
+/// per thread, see run_headless.
+static _Thread_local unsigned int bench_rng_state = 1;
+
+static unsigned int bench_rand() {
+    bench_rng_state = bench_rng_state * 1103515245u + 12345u;
+    return (bench_rng_state >> 16) & 0x7fff;
+}
+
+static const Script_Step script_idle[] = {
+    {.ticks = 1},
+};
+
+static const Script_Step script_dodge_and_shoot[] = {
+    {.ticks = 20, .shoot = true, .up = true},
+    {.ticks = 12, .shoot = true, .right = true},
+    {.ticks = 20, .shoot = true, .down = true},
+    {.ticks = 12, .shoot = true, .left = true},
+    {.ticks = 8, .shoot = true},
+    {.ticks = 6},
+};
+
+static void prepare_max_player_pews(Game_State* game_state, int tick) {
+    // keep the player alive and the pew array topped up
+    game_state->lifes_left = 3;
+    int slot = 0;
+    while (game_state->pews.len < PEW_CAP) {
+        pew_add(
+            &game_state->pews,
+            (Pew){
+                .x = fou_num_from_int((tick + slot * 4) % 120),
+                .y = fou_num_from_int((slot * 7) % 56),
+            });
+        slot++;
+    }
+}
+
+static void prepare_dense_enemy_fire(Game_State* game_state, int tick) {
+    (void)tick;
+    // Player collision is checked every tick and never ends the run.
+    game_state->lifes_left = 3;
+    game_state->invincibility_frames_left = 0;
+    while (game_state->enemy_pews.len < ENEMY_PEW_CAP) {
+        // speeds in steps of 1/32 pixel, exact in both number representations
+        Fou_Num h_speed = FOU_NUM(-0.25) - fou_num_from_int(bench_rand() % 64) / 32;
+        Fou_Num v_speed = fou_num_from_int((int)(bench_rand() % 64) - 32) / 32;
+        enemypew_add(
+            &game_state->enemy_pews,
+            (EnemyPew){
+                .x = fou_num_from_int(48 + bench_rand() % 72),
+                .y = fou_num_from_int(bench_rand() % 56),
+                .h_speed = h_speed,
+                .v_speed = v_speed,
+            });
+    }
+}
+
+static void prepare_enemy_stages(Game_State* game_state, int tick) {
+    // walk through all emitter stages, a few thousand ticks each
+    game_state->lifes_left = 3;
+    int boss = enemy_index(&game_state->enemies, game_state->boss);
+    if (boss >= 0) game_state->enemies.hits_taken[boss] = (tick / 4000) % 8 * 10;
+}
+
+static void prepare_death_loop(Game_State* game_state, int tick) {
+    (void)tick;
+    // drop a motionless enemy pew onto the player whenever they can be hit
+    if (game_state->lifes_left != 0 && game_state->invincibility_frames_left == 0) {
+        enemypew_add(
+            &game_state->enemy_pews,
+            (EnemyPew){
+                .x = game_state->player.x,
+                .y = game_state->player.y,
+                .h_speed = 0,
+                .v_speed = 0,
+            });
+    }
+}
+
+static void prepare_paused(Game_State* game_state, int tick) {
+    (void)tick;
+    game_state->paused = true;
+}
+
+#define SCRIPT(s) (s), (int)(sizeof(s) / sizeof((s)[0]))
+
+static const Scenario scenarios[] = {
+    {
+        .name = "idle",
+        .description = "no input at all",
+        SCRIPT(script_idle),
+        .prepare = NULL,
+    },
+    {
+        .name = "play",
+        .description = "scripted dodging while holding shoot",
+        SCRIPT(script_dodge_and_shoot),
+        .prepare = NULL,
+    },
+    {
+        .name = "max_pews",
+        .description = "player pew array kept full",
+        SCRIPT(script_dodge_and_shoot),
+        .prepare = prepare_max_player_pews,
+    },
+    {
+        .name = "dense_fire",
+        .description = "enemy pew array kept full, player hit test every tick",
+        SCRIPT(script_idle),
+        .prepare = prepare_dense_enemy_fire,
+    },
+    {
+        .name = "stages",
+        .description = "enemy cycles through all emitter stages, player keeps its lifes",
+        SCRIPT(script_dodge_and_shoot),
+        .prepare = prepare_enemy_stages,
+    },
+    {
+        .name = "death_loop",
+        .description = "player dies as fast as possible, game resets over and over",
+        SCRIPT(script_idle),
+        .prepare = prepare_death_loop,
+    },
+    {
+        .name = "paused",
+        .description = "pause screen, every frame is the same",
+        SCRIPT(script_idle),
+        .prepare = prepare_paused,
+    },
+};
+
+// input comes from the replay passed with -p
+static const Scenario replay_scenario = {
+    .name = "replay",
+    .description = "recorded input",
+    SCRIPT(script_idle),
+    .prepare = NULL,
+};
+
+#define SCENARIO_COUNT (int)(sizeof(scenarios) / sizeof(scenarios[0]))
+
+static Fou_User_Input_State script_input(const Scenario* scenario, int tick) {
+    int script_ticks = 0;
+    for (int i = 0; i < scenario->script_len; i++) {
+        script_ticks += scenario->script[i].ticks;
+    }
+    int t = tick % script_ticks;
+    const Script_Step* step = scenario->script;
+    while (t >= step->ticks) {
+        t -= step->ticks;
+        step++;
+    }
+    return (Fou_User_Input_State){
+        .up = step->up,
+        .down = step->down,
+        .left = step->left,
+        .right = step->right,
+        .shoot = step->shoot,
+        .back = false,
+    };
+}
+
+static unsigned int hash_bytes(unsigned int hash, const void* data, size_t size) {
+    const unsigned char* bytes = data;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+/// Enemy by enemy and field by field, paths have padding.
+static unsigned int hash_enemies(unsigned int hash, const Enemies* enemies) {
+    hash = hash_bytes(hash, &enemies->len, sizeof(enemies->len));
+    hash = hash_bytes(hash, enemies->slot, sizeof(enemies->slot));
+    hash = hash_bytes(hash, enemies->generation, sizeof(enemies->generation));
+    for (int i = 0; i < enemies->len; i++) {
+        const Enemy_Path* path = &enemies->path[i];
+        hash = hash_bytes(hash, &enemies->kind[i], sizeof(enemies->kind[i]));
+        hash = hash_bytes(hash, &enemies->hit_cooldown[i], sizeof(enemies->hit_cooldown[i]));
+        hash = hash_bytes(hash, &enemies->health[i], sizeof(enemies->health[i]));
+        hash = hash_bytes(hash, &enemies->stage[i], sizeof(enemies->stage[i]));
+        hash = hash_bytes(hash, &enemies->hits_taken[i], sizeof(enemies->hits_taken[i]));
+        hash = hash_bytes(hash, &enemies->spawn_tick[i], sizeof(enemies->spawn_tick[i]));
+        hash = hash_bytes(hash, &enemies->x[i], sizeof(enemies->x[i]));
+        hash = hash_bytes(hash, &enemies->y[i], sizeof(enemies->y[i]));
+        hash = hash_bytes(hash, &path->kind, sizeof(path->kind));
+        hash = hash_bytes(hash, &path->turn, sizeof(path->turn));
+        hash = hash_bytes(hash, &path->x, sizeof(path->x));
+        hash = hash_bytes(hash, &path->y, sizeof(path->y));
+        hash = hash_bytes(hash, &path->dx, sizeof(path->dx));
+        hash = hash_bytes(hash, &path->dy, sizeof(path->dy));
+        hash = hash_bytes(hash, &path->amplitude, sizeof(path->amplitude));
+        hash = hash_bytes(hash, enemies->emitters[i], sizeof(enemies->emitters[i]));
+    }
+    return hash;
+}
+
+/// FNV-1a over everything the simulation depends on, all but the particles,
+/// which it writes but never reads. Rewind snapshots leave the particles out
+/// as well.
+static unsigned int hash_simulation(const Game_State* game_state) {
+    unsigned int hash = 2166136261u;
+    hash = hash_bytes(hash, &game_state->ticks, sizeof(game_state->ticks));
+    hash = hash_bytes(hash, &game_state->player, sizeof(game_state->player));
+    // bit-fields, hashed by value
+    uint8_t counters[] = {
+        game_state->lifes_left,
+        game_state->ticks_since_death,
+        game_state->shoot_cooldown_left,
+        game_state->invincibility_frames_left,
+    };
+    hash = hash_bytes(hash, counters, sizeof(counters));
+    hash = hash_enemies(hash, &game_state->enemies);
+    hash = hash_bytes(hash, &game_state->boss, sizeof(game_state->boss));
+    hash = hash_bytes(hash, &game_state->waves.wave, sizeof(game_state->waves.wave));
+    hash = hash_bytes(hash, &game_state->waves.spawned, sizeof(game_state->waves.spawned));
+    hash = hash_bytes(hash, &game_state->waves.next_tick, sizeof(game_state->waves.next_tick));
+    // bullet by bullet, whatever the layout of the pools
+    hash = hash_bytes(hash, &game_state->pews.len, sizeof(game_state->pews.len));
+    for (int i = 0; i < game_state->pews.len; i++) {
+        Pew pew = pew_get(&game_state->pews, i);
+        hash = hash_bytes(hash, &pew, sizeof(pew));
+    }
+    hash = hash_bytes(hash, &game_state->enemy_pews.len, sizeof(game_state->enemy_pews.len));
+    for (int i = 0; i < game_state->enemy_pews.len; i++) {
+        // field by field, EnemyPew has padding
+        EnemyPew pew = enemypew_get(&game_state->enemy_pews, i);
+        hash = hash_bytes(hash, &pew.x, sizeof(pew.x));
+        hash = hash_bytes(hash, &pew.y, sizeof(pew.y));
+        hash = hash_bytes(hash, &pew.v_speed, sizeof(pew.v_speed));
+        hash = hash_bytes(hash, &pew.h_speed, sizeof(pew.h_speed));
+        hash = hash_bytes(hash, &pew.param, sizeof(pew.param));
+        hash = hash_bytes(hash, &pew.ticks, sizeof(pew.ticks));
+        hash = hash_bytes(hash, &pew.behavior, sizeof(pew.behavior));
+    }
+    return hash;
+}
+
+/// hash_simulation and the particles, all of the game that is drawn. Runs of
+/// the same build configuration must produce the same hash on every platform.
+static unsigned int hash_game_state(const Game_State* game_state) {
+    unsigned int hash = hash_simulation(game_state);
+    const Particles* particles = &game_state->particles;
+    hash = hash_bytes(hash, &particles->len, sizeof(particles->len));
+    for (int i = 0; i < particles->len; i++) {
+        // field by field, Particle has padding
+        Particle particle = particle_get(particles, i);
+        hash = hash_bytes(hash, &particle.x, sizeof(particle.x));
+        hash = hash_bytes(hash, &particle.y, sizeof(particle.y));
+        hash = hash_bytes(hash, &particle.h_speed, sizeof(particle.h_speed));
+        hash = hash_bytes(hash, &particle.v_speed, sizeof(particle.v_speed));
+        hash = hash_bytes(hash, &particle.ticks_left, sizeof(particle.ticks_left));
+        hash = hash_bytes(hash, &particle.size, sizeof(particle.size));
+    }
+    return hash;
+}
+
+static long long now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000ll + ts.tv_nsec;
+}
+
+/// Write `raster` as a binary PBM, without the strings it would draw.
+static void write_pbm(const Raster* raster, const char* path) {
+    FILE* file = fopen(path, "wb");
+    if (file == NULL) {
+        perror(path);
+        return;
+    }
+    fprintf(file, "P4\n%d %d\n", RASTER_WIDTH, RASTER_HEIGHT);
+    for (int y = 0; y < RASTER_HEIGHT; y++) {
+        for (int x = 0; x < RASTER_WIDTH; x += 8) {
+            uint8_t byte = 0;
+            for (int bit = 0; bit < 8; bit++) {
+                byte |= raster_pixel(raster, x + bit, y) << (7 - bit);
+            }
+            fputc(byte, file);
+        }
+    }
+    fclose(file);
+}
+
+/// Write out whatever block the recorder handed over.
+static size_t drain_recorder(Replay_Recorder* recorder, FILE* file) {
+    const Replay_Block* block = replay_recorder_full_block(recorder);
+    if (block == NULL) return 0;
+    fwrite(block->bytes, 1, block->size, file);
+    replay_recorder_block_written(recorder);
+    return block->size;
+}
+
+/// Reads all of `path` into a malloc'd buffer, NULL on failure.
+static uint8_t* read_file(const char* path, size_t* size) {
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+        perror(path);
+        return NULL;
+    }
+    size_t capacity = 4096;
+    uint8_t* data = malloc(capacity);
+    *size = 0;
+    size_t n;
+    while (data != NULL && (n = fread(data + *size, 1, capacity - *size, file)) > 0) {
+        *size += n;
+        if (*size == capacity) {
+            capacity *= 2;
+            uint8_t* grown = realloc(data, capacity);
+            if (grown == NULL) free(data);
+            data = grown;
+        }
+    }
+    fclose(file);
+    return data;
+}
+
+#if FOU_PROFILE
+static void write_trace_chunk(void* context, const void* data, size_t size) {
+    fwrite(data, 1, size, context);
+}
+#endif
+
+/// `player` replaces the scenario's script if it is not NULL, the run ends
+/// with the replay then.
+static void run_scenario(const Scenario* scenario, int ticks, Replay_Player* player) {
+    bench_rng_state = 1;
+    profile_init(&fou_profiler);
+    Game_State game_state = fou_init_game_state();
+    Fou_User_Input_State prev_input = {0};
+
+    long long total_ns = 0;
+    long long max_ns = 0;
+    long total_draw_calls = 0;
+    long max_draw_calls = 0;
+    int peak_pews = 0;
+    int peak_enemy_pews = 0;
+    int peak_particles = 0;
+    int peak_enemies = 0;
+    long draw_calls_by_kind[HOST_DRAW_KIND_COUNT] = {0};
+    static Draw_Optimizer optimizer;
+    static Raster raster;
+    static Raster dirty_raster; // only ever redrawn where the frame changed
+    static Dirty_Tracker dirty_tracker;
+    dirty_tracker_reset(&dirty_tracker);
+    long long opt_ns = 0;
+    long long raster_ns = 0;
+    long long dirty_ns = 0;
+    long dirty_tiles = 0;
+    int unchanged_frames = 0;
+    int partial_frames = 0;
+    int dirty_differ = 0;
+    Draw_Opt_Stats opt_total = {0};
+    static Host_Draw host_draw;
+    host_draw_init(&host_draw);
+    Fou_Render_Target target = host_draw_target(&host_draw);
+
+    // Snapshots of every tick, with the hash of each state to check restoring
+    // them against.
+    static Rewind_Ring rewind_ring;
+    static unsigned int rewind_hashes[REWIND_MAX_SNAPSHOTS];
+    rewind_init(&rewind_ring);
+    long long rewind_ns = 0;
+
+    static Replay_Recorder recorder;
+    FILE* record_file = NULL;
+    size_t recorded_bytes = 0;
+    if (record_prefix != NULL) {
+        char path[256];
+        snprintf(path, sizeof(path), "%s%s.fourep", record_prefix, scenario->name);
+        record_file = fopen(path, "wb");
+        if (record_file == NULL) perror(path);
+        replay_recorder_init(&recorder);
+    }
+
+    int tick;
+    for (tick = 0; tick < ticks; tick++) {
+        Fou_User_Input_State input;
+        if (player == NULL) {
+            input = script_input(scenario, tick);
+        } else if (!replay_player_next(player, &input)) {
+            break;
+        }
+        if (record_file != NULL && replay_recorder_tick(&recorder, input)) {
+            recorded_bytes += drain_recorder(&recorder, record_file);
+        }
+        if (scenario->prepare) {
+            scenario->prepare(&game_state, tick);
+        }
+        if (game_state.pews.len > peak_pews) peak_pews = game_state.pews.len;
+        if (game_state.enemy_pews.len > peak_enemy_pews) peak_enemy_pews = game_state.enemy_pews.len;
+
+        host_draw_reset(&host_draw);
+        long long start = now_ns();
+        fou_frame(&target, &game_state, input, prev_input);
+        long long elapsed = now_ns() - start;
+
+        total_ns += elapsed;
+        if (elapsed > max_ns) max_ns = elapsed;
+        long draw_calls = host_draw_total(&host_draw);
+        total_draw_calls += draw_calls;
+        if (draw_calls > max_draw_calls) max_draw_calls = draw_calls;
+        for (int k = 0; k < HOST_DRAW_KIND_COUNT; k++) {
+            draw_calls_by_kind[k] += host_draw.stats.calls[k];
+        }
+        if (game_state.pews.len > peak_pews) peak_pews = game_state.pews.len;
+        if (game_state.enemy_pews.len > peak_enemy_pews) peak_enemy_pews = game_state.enemy_pews.len;
+        if (game_state.particles.len > peak_particles) peak_particles = game_state.particles.len;
+        if (game_state.enemies.len > peak_enemies) peak_enemies = game_state.enemies.len;
+
+        start = now_ns();
+        draw_list_optimize(&optimizer, &host_draw.list);
+        opt_ns += now_ns() - start;
+        start = now_ns();
+        PROFILE_BEGIN(REPLAY);
+        raster_draw_list(&raster, &host_draw.list);
+        PROFILE_END(REPLAY);
+        raster_ns += now_ns() - start;
+
+        start = now_ns();
+        uint32_t dirty = dirty_tracker_update(&dirty_tracker, &host_draw.list);
+        if (dirty != 0) {
+            raster_draw_list_tiles(&dirty_raster, &host_draw.list, dirty, dirty_tracker.call_tiles);
+        }
+        dirty_ns += now_ns() - start;
+        if (dirty == 0) {
+            unchanged_frames++;
+        } else if (__builtin_popcount(dirty) <= RASTER_MAX_PARTIAL_TILES) {
+            partial_frames++;
+            dirty_tiles += __builtin_popcount(dirty);
+        }
+        if (!raster_equal(&dirty_raster, &raster)) {
+            dirty_differ++;
+        }
+        start = now_ns();
+        rewind_push(&rewind_ring, &game_state);
+        rewind_ns += now_ns() - start;
+        rewind_hashes[tick % REWIND_MAX_SNAPSHOTS] = hash_simulation(&game_state);
+
+        opt_total.calls_out += optimizer.stats.calls_out;
+        opt_total.culled += optimizer.stats.culled;
+        opt_total.state_calls_removed += optimizer.stats.state_calls_removed;
+        opt_total.batched += optimizer.stats.batched;
+        prev_input = input;
+    }
+    ticks = tick;
+    Draw_List_Stats arena = host_draw.list.stats;
+    host_draw_free(&host_draw);
+    if (ticks == 0) return;
+
+    if (record_file != NULL) {
+        recorded_bytes += drain_recorder(&recorder, record_file);
+        const Replay_Block* tail = replay_recorder_finish(&recorder);
+        fwrite(tail->bytes, 1, tail->size, record_file);
+        recorded_bytes += tail->size;
+        fclose(record_file);
+    }
+
+    printf("%-12s %9.1f ns/tick (max %7lld ns)  draw calls/frame %6.1f (max %4ld)  "
+           "peak pews %3d/%d  peak enemy pews %3d/%d  peak particles %3d/%d  peak enemies %2d/%d\n",
+           scenario->name,
+           (double)total_ns / ticks,
+           max_ns,
+           (double)total_draw_calls / ticks,
+           max_draw_calls,
+           peak_pews,
+           PEW_CAP,
+           peak_enemy_pews,
+           ENEMY_PEW_CAP,
+           peak_particles,
+           PARTICLE_CAP,
+           peak_enemies,
+           ENEMY_CAP);
+    printf("%-12s state %08x; dropped pews %d, enemy pews %d, particles %d, enemies %d;",
+           "",
+           hash_game_state(&game_state),
+           game_state.pews.dropped,
+           game_state.enemy_pews.dropped,
+           game_state.particles.dropped,
+           game_state.enemies.dropped);
+    for (int k = 0; k < HOST_DRAW_KIND_COUNT; k++) {
+        if (draw_calls_by_kind[k] != 0) {
+            printf(" %s %.1f", host_draw_kind_name(k), (double)draw_calls_by_kind[k] / ticks);
+        }
+    }
+    printf("\n");
+    printf("%-12s optimized %6.1f calls/frame in %.1f ns; culled %.1f, state calls removed %.1f, "
+           "batched %.1f\n",
+           "",
+           (double)opt_total.calls_out / ticks,
+           (double)opt_ns / ticks,
+           (double)opt_total.culled / ticks,
+           (double)opt_total.state_calls_removed / ticks,
+           (double)opt_total.batched / ticks);
+    // what redrawing only what changed saves over rasterizing every frame
+    printf("%-12s rasterized in %.1f ns/frame; dirty redraw in %.1f ns/frame (%+.0f%%), "
+           "%d differ\n",
+           "",
+           (double)raster_ns / ticks,
+           (double)dirty_ns / ticks,
+           100.0 * (dirty_ns - raster_ns) / raster_ns,
+           dirty_differ);
+    printf("%-12s frames unchanged %d, redrawn in part %d (%.1f/%d tiles), redrawn whole %d\n",
+           "",
+           unchanged_frames,
+           partial_frames,
+           partial_frames != 0 ? (double)dirty_tiles / partial_frames : 0.0,
+           RASTER_TILE_COUNT,
+           ticks - unchanged_frames - partial_frames);
+
+    printf("%-12s arena peak %zu/%zu bytes (%zu calls, %zu string bytes); dropped low %lu, "
+           "normal %lu\n",
+           "",
+           arena.peak_bytes,
+           DRAW_LIST_ARENA_SIZE,
+           arena.peak_calls,
+           arena.peak_string_bytes,
+           arena.dropped_low,
+           arena.dropped_normal);
+
+    // fork the game from every tick still in the ring
+    long long restore_max_ns = 0;
+    size_t rewind_bytes = 0;
+    int restore_mismatches = 0;
+    for (int back = 0; back < rewind_count(&rewind_ring); back++) {
+        Game_State fork;
+        long long start = now_ns();
+        rewind_restore(&rewind_ring, back, &fork);
+        long long elapsed = now_ns() - start;
+        if (elapsed > restore_max_ns) restore_max_ns = elapsed;
+        int restored_tick = ticks - 1 - back;
+        if (hash_simulation(&fork) != rewind_hashes[restored_tick % REWIND_MAX_SNAPSHOTS]) {
+            restore_mismatches++;
+        }
+    }
+    for (int i = 0; i < rewind_count(&rewind_ring); i++) {
+        rewind_bytes += rewind_ring.snapshots[(rewind_ring.first + i) % REWIND_MAX_SNAPSHOTS].size;
+    }
+    printf("%-12s rewind %d ticks in %zu/%d bytes, push %.1f ns/tick, restore max %lld ns, "
+           "%d restored states differ\n",
+           "",
+           rewind_count(&rewind_ring),
+           rewind_bytes,
+           REWIND_BUFFER_SIZE,
+           (double)rewind_ns / ticks,
+           restore_max_ns,
+           restore_mismatches);
+
+#if FOU_PROFILE
+    printf("%-12s profiled avg", "");
+    for (int phase = 0; phase < PROFILE_PHASE_COUNT; phase++) {
+        uint64_t ns =
+            (uint64_t)profile_average(&fou_profiler, phase) * 1000000000u / PROFILE_CLOCK_HZ;
+        printf(" %s %llu ns", profile_phase_name(phase), (unsigned long long)ns);
+    }
+    printf("\n");
+    if (trace_prefix != NULL) {
+        char path[256];
+        snprintf(path, sizeof(path), "%s%s.foup", trace_prefix, scenario->name);
+        FILE* trace_file = fopen(path, "wb");
+        if (trace_file == NULL) {
+            perror(path);
+        } else {
+            profile_trace_write(&fou_profiler, write_trace_chunk, trace_file);
+            fclose(trace_file);
+        }
+    }
+#endif
+
+    if (record_file != NULL) {
+        printf("%-12s recorded %d ticks of input in %zu bytes\n", "", ticks, recorded_bytes);
+    }
+
+    if (dump_prefix != NULL) {
+        char path[256];
+        snprintf(path, sizeof(path), "%s%s.pbm", dump_prefix, scenario->name);
+        write_pbm(&raster, path);
+    }
+}
+
+typedef struct {
+    const Scenario* scenario;
+    int ticks;
+    unsigned int hash;
+    long long ns;
+} Headless_Run;
+
+/// Simulate without drawing anything, all state is on the thread's stack.
+static void* run_headless(void* context) {
+    Headless_Run* run = context;
+    bench_rng_state = 1;
+    Game_State game_state = fou_init_game_state();
+    Fou_User_Input_State prev_input = {0};
+    long long start = now_ns();
+    for (int tick = 0; tick < run->ticks; tick++) {
+        Fou_User_Input_State input = script_input(run->scenario, tick);
+        if (run->scenario->prepare) {
+            run->scenario->prepare(&game_state, tick);
+        }
+        fou_step(&game_state, input, prev_input);
+        prev_input = input;
+    }
+    run->ns = now_ns() - start;
+    run->hash = hash_game_state(&game_state);
+    return NULL;
+}
+
+/// Run `scenario` headless on `threads` threads at once, each on a Game_State
+/// of its own, and check they all end up where a single run does.
+static void run_scenario_threaded(const Scenario* scenario, int ticks, int threads) {
+    Headless_Run single = {.scenario = scenario, .ticks = ticks};
+    run_headless(&single);
+
+    Headless_Run* runs = calloc(threads, sizeof(Headless_Run));
+    pthread_t* ids = calloc(threads, sizeof(pthread_t));
+    if (runs == NULL || ids == NULL) {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+    long long start = now_ns();
+    int started = 0;
+    for (; started < threads; started++) {
+        runs[started] = (Headless_Run){.scenario = scenario, .ticks = ticks};
+        if (pthread_create(&ids[started], NULL, run_headless, &runs[started]) != 0) break;
+    }
+    int differ = 0;
+    for (int i = 0; i < started; i++) {
+        pthread_join(ids[i], NULL);
+        if (runs[i].hash != single.hash) differ++;
+    }
+    long long wall_ns = now_ns() - start;
+
+    printf("%-12s headless %9.1f ns/tick, %d threads %.1f Mticks/s, state %08x, "
+           "%d runs differ\n",
+           scenario->name,
+           (double)single.ns / ticks,
+           started,
+           (double)ticks * started / wall_ns * 1000,
+           single.hash,
+           differ);
+    free(ids);
+    free(runs);
+}
+
+/// Where the bytes of a Game_State go, padding included, all known at compile
+/// time, against the budgets flouhou.h asserts.
+static void print_state_layout(void) {
+    size_t cold = offsetof(Game_State, particles) + sizeof(((Game_State*)0)->particles);
+    printf(
+        "Game_State %zu bytes: ticks and player %zu, pews %zu, enemy pews %zu, enemies %zu, "
+        "particles %zu, cold %zu\n",
+        sizeof(Game_State),
+        offsetof(Game_State, pews),
+        offsetof(Game_State, enemy_pews) - offsetof(Game_State, pews),
+        offsetof(Game_State, enemies) - offsetof(Game_State, enemy_pews),
+        offsetof(Game_State, particles) - offsetof(Game_State, enemies),
+        cold - offsetof(Game_State, particles),
+        sizeof(Game_State) - cold);
+#if FOU_FIXED_POINT
+    printf(
+        "budgets: hot %zu of %zu bytes, all %zu of %zu bytes\n",
+        offsetof(Game_State, particles),
+        (size_t)GAME_STATE_HOT_BUDGET,
+        sizeof(Game_State),
+        (size_t)GAME_STATE_BUDGET);
+#endif
+}
+
+static void usage(const char* argv0) {
+    fprintf(
+        stderr,
+        "usage: %s [-n ticks] [-d dump_prefix] [-r record_prefix] [-t trace_prefix]\n"
+        "          [-j threads] [-p replay] [scenario...]\n\n"
+        "-p plays back a recorded input replay instead of the scenarios, for at most\n"
+        "-n ticks if given\n"
+        "-j only simulates, with fou_step on as many threads at once\n\nscenarios:\n",
+        argv0);
+    for (int i = 0; i < SCENARIO_COUNT; i++) {
+        fprintf(stderr, "  %-12s %s\n", scenarios[i].name, scenarios[i].description);
+    }
+}
+
+int main(int argc, char** argv) {
+    int ticks = DEFAULT_TICKS;
+    bool ticks_given = false;
+    const char* selected[SCENARIO_COUNT];
+    int selected_count = 0;
+    const char* replay_path = NULL;
+    int threads = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            ticks = atoi(argv[++i]);
+            ticks_given = true;
+        } else if (strcmp(argv[i], "-d") == 0 && i + 1 < argc) {
+            dump_prefix = argv[++i];
+        } else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+            record_prefix = argv[++i];
+        } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            trace_prefix = argv[++i];
+        } else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-p") == 0 && i + 1 < argc) {
+            replay_path = argv[++i];
+        } else if (argv[i][0] == '-') {
+            usage(argv[0]);
+            return 1;
+        } else if (selected_count < SCENARIO_COUNT) {
+            selected[selected_count++] = argv[i];
+        }
+    }
+    if (ticks <= 0 || threads < 0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    if (replay_path != NULL) {
+        size_t size;
+        uint8_t* data = read_file(replay_path, &size);
+        if (data == NULL) return 1;
+        Replay_Player player;
+        if (!replay_player_init(&player, data, size)) {
+            fprintf(stderr, "%s is not a replay\n", replay_path);
+            free(data);
+            return 1;
+        }
+        // as long as the replay lasts unless -n says otherwise
+        run_scenario(&replay_scenario, ticks_given ? ticks : INT_MAX, &player);
+        free(data);
+        return 0;
+    }
+
+    for (int j = 0; j < selected_count; j++) {
+        bool known = false;
+        for (int i = 0; i < SCENARIO_COUNT; i++) {
+            if (strcmp(selected[j], scenarios[i].name) == 0) known = true;
+        }
+        if (!known) {
+            fprintf(stderr, "unknown scenario '%s'\n", selected[j]);
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    print_state_layout();
+    for (int i = 0; i < SCENARIO_COUNT; i++) {
+        bool run = selected_count == 0;
+        for (int j = 0; j < selected_count; j++) {
+            if (strcmp(selected[j], scenarios[i].name) == 0) run = true;
+        }
+        if (run && threads > 0) {
+            run_scenario_threaded(&scenarios[i], ticks, threads);
+        } else if (run) {
+            run_scenario(&scenarios[i], ticks, NULL);
+        }
+    }
+    return 0;
+}
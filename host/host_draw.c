@@ -0,0 +1,129 @@
+#include <stdbool.h>
+#include <string.h>
+
+#include "core/draw_list.h"
+#include "core/flouhou.h"
+#include "host_draw.h"
+
+void host_draw_init(Host_Draw* host_draw) {
+    memset(&host_draw->stats, 0, sizeof(host_draw->stats));
+    draw_list_init(&host_draw->list);
+    host_draw->list_target = draw_list_render_target(&host_draw->list);
+}
+
+void host_draw_free(Host_Draw* host_draw) {
+    draw_list_free(&host_draw->list);
+}
+
+void host_draw_reset(Host_Draw* host_draw) {
+    memset(&host_draw->stats, 0, sizeof(host_draw->stats));
+    draw_list_clear(&host_draw->list);
+}
+
+long host_draw_total(const Host_Draw* host_draw) {
+    long total = 0;
+    for (int i = 0; i < HOST_DRAW_KIND_COUNT; i++) {
+        total += host_draw->stats.calls[i];
+    }
+    return total;
+}
+
+const char* host_draw_kind_name(Host_Draw_Kind kind) {
+    switch (kind) {
+        case HOST_DRAW_BOX: return "box";
+        case HOST_DRAW_DISC: return "disc";
+        case HOST_DRAW_DOT: return "dot";
+        case HOST_DRAW_FRAME: return "frame";
+        case HOST_DRAW_ICON: return "icon";
+        case HOST_DRAW_OUTLINED_ICON: return "outlined_icon";
+        case HOST_DRAW_STR: return "str";
+        case HOST_DRAW_INVERT_COLOR: return "invert_color";
+        case HOST_DRAW_SET_BITMAP_MODE: return "set_bitmap_mode";
+        case HOST_DRAW_SET_COLOR: return "set_color";
+        case HOST_DRAW_KIND_COUNT: break;
+    }
+    return "?";
+}
+
+static void draw_box(void* context, int x, int y, int width, int height) {
+    Host_Draw* host_draw = context;
+    host_draw->stats.calls[HOST_DRAW_BOX]++;
+    fou_draw_box(&host_draw->list_target, x, y, width, height);
+}
+
+static void draw_disc(void* context, int x, int y, int radius) {
+    Host_Draw* host_draw = context;
+    host_draw->stats.calls[HOST_DRAW_DISC]++;
+    fou_draw_disc(&host_draw->list_target, x, y, radius);
+}
+
+static void draw_dot(void* context, int x, int y) {
+    Host_Draw* host_draw = context;
+    host_draw->stats.calls[HOST_DRAW_DOT]++;
+    fou_draw_dot(&host_draw->list_target, x, y);
+}
+
+static void draw_frame(void* context, int x, int y, int width, int height) {
+    Host_Draw* host_draw = context;
+    host_draw->stats.calls[HOST_DRAW_FRAME]++;
+    fou_draw_frame(&host_draw->list_target, x, y, width, height);
+}
+
+static void draw_icon(void* context, int x, int y, Fou_Icon icon) {
+    Host_Draw* host_draw = context;
+    host_draw->stats.calls[HOST_DRAW_ICON]++;
+    fou_draw_icon(&host_draw->list_target, x, y, icon);
+}
+
+static void draw_outlined_icon(void* context, int x, int y, Fou_Icon icon) {
+    Host_Draw* host_draw = context;
+    host_draw->stats.calls[HOST_DRAW_OUTLINED_ICON]++;
+    fou_draw_outlined_icon(&host_draw->list_target, x, y, icon);
+}
+
+static void draw_str(void* context, int x, int y, const char* string, Fou_Str_Flags flags) {
+    Host_Draw* host_draw = context;
+    host_draw->stats.calls[HOST_DRAW_STR]++;
+    fou_draw_styled_str(&host_draw->list_target, x, y, string, flags);
+}
+
+static void invert_color(void* context) {
+    Host_Draw* host_draw = context;
+    host_draw->stats.calls[HOST_DRAW_INVERT_COLOR]++;
+    fou_invert_color(&host_draw->list_target);
+}
+
+static void set_bitmap_mode(void* context, bool alpha) {
+    Host_Draw* host_draw = context;
+    host_draw->stats.calls[HOST_DRAW_SET_BITMAP_MODE]++;
+    fou_set_bitmap_mode(&host_draw->list_target, alpha);
+}
+
+static void set_color(void* context, bool color) {
+    Host_Draw* host_draw = context;
+    host_draw->stats.calls[HOST_DRAW_SET_COLOR]++;
+    fou_set_color(&host_draw->list_target, color);
+}
+
+static void set_draw_priority(void* context, Fou_Draw_Priority priority) {
+    Host_Draw* host_draw = context;
+    fou_set_draw_priority(&host_draw->list_target, priority);
+}
+
+static const Fou_Render_Functions render_functions = {
+    .draw_box = draw_box,
+    .draw_disc = draw_disc,
+    .draw_dot = draw_dot,
+    .draw_frame = draw_frame,
+    .draw_icon = draw_icon,
+    .draw_outlined_icon = draw_outlined_icon,
+    .draw_str = draw_str,
+    .invert_color = invert_color,
+    .set_bitmap_mode = set_bitmap_mode,
+    .set_color = set_color,
+    .set_draw_priority = set_draw_priority,
+};
+
+Fou_Render_Target host_draw_target(Host_Draw* host_draw) {
+    return (Fou_Render_Target){.functions = &render_functions, .context = host_draw};
+}
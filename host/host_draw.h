@@ -0,0 +1,50 @@
+/*
+ * Counting render target for the benchmark. Nothing is rendered, every call
+ * is only tallied and recorded into the target's draw list so the benchmark
+ * can report how much work a frame would hand to the GUI.
+ */
+
+#ifndef HOST_DRAW_H
+#define HOST_DRAW_H
+
+#include "core/draw_list.h"
+#include "core/flouhou.h"
+
+typedef enum {
+    HOST_DRAW_BOX,
+    HOST_DRAW_DISC,
+    HOST_DRAW_DOT,
+    HOST_DRAW_FRAME,
+    HOST_DRAW_ICON,
+    HOST_DRAW_OUTLINED_ICON,
+    HOST_DRAW_STR,
+    HOST_DRAW_INVERT_COLOR,
+    HOST_DRAW_SET_BITMAP_MODE,
+    HOST_DRAW_SET_COLOR,
+    HOST_DRAW_KIND_COUNT,
+} Host_Draw_Kind;
+
+typedef struct {
+    long calls[HOST_DRAW_KIND_COUNT];
+} Host_Draw_Stats;
+
+typedef struct {
+    Host_Draw_Stats stats; // of the current frame
+    Draw_List list;
+    Fou_Render_Target list_target; // where the counted calls go on to
+} Host_Draw;
+
+void host_draw_init(Host_Draw* host_draw);
+
+void host_draw_free(Host_Draw* host_draw);
+
+/// Start a new frame, keeps the stats of the draw list.
+void host_draw_reset(Host_Draw* host_draw);
+
+Fou_Render_Target host_draw_target(Host_Draw* host_draw);
+
+long host_draw_total(const Host_Draw* host_draw);
+
+const char* host_draw_kind_name(Host_Draw_Kind kind);
+
+#endif
@@ -0,0 +1,84 @@
+#!/usr/bin/env python3
+"""
+Generates core/math_tables.h, the lookup tables used by core/fou_math.c.
+
+    python3 tools/gen_math_tables.py > core/math_tables.h
+
+All values are emitted as integers so the tables mean exactly the same thing
+on every platform, whatever number representation the game is built with.
+"""
+
+import math
+
+SINE_TABLE_BITS = 8
+
+# Enemy trajectory, x and y are sine waves with these frequencies in radians
+# per tick.
+ENEMY_PATH_X_FREQUENCY = 0.1
+ENEMY_PATH_Y_FREQUENCY = 0.075982851
+
+# Controls how quickly the enemy shoots and how quickly its projectiles
+# become as it takes more hits.
+ENEMY_COOLDOWN_RETENTION_PER_HIT = 0.98
+ENEMY_BASE_SHOOT_COOLDOWN = 24
+# past this many hits the enemy does not get any faster
+ENEMY_MAX_SCALED_HITS = 255
+
+
+def phase_step(frequency):
+    """Radians per tick as a 32 bit fraction of a full turn."""
+    return round(frequency / (2 * math.pi) * 2**32) % 2**32
+
+
+def rows(values, per_row, fmt):
+    out = []
+    for i in range(0, len(values), per_row):
+        out.append("    " + " ".join(fmt(v) + "," for v in values[i:i + per_row]))
+    return "\n".join(out)
+
+
+def main():
+    sine_len = 1 << SINE_TABLE_BITS
+    # one extra entry so interpolation never has to wrap
+    sine = [round(math.sin(2 * math.pi * i / sine_len) * 16384) for i in range(sine_len + 1)]
+
+    hits = range(ENEMY_MAX_SCALED_HITS + 1)
+    cooldown = [int(ENEMY_BASE_SHOOT_COOLDOWN * ENEMY_COOLDOWN_RETENTION_PER_HIT**h) for h in hits]
+    speed = [round((1 / ENEMY_COOLDOWN_RETENTION_PER_HIT)**h * 65536) for h in hits]
+
+    print(f"""/*
+ * Generated by tools/gen_math_tables.py, do not edit.
+ */
+
+#ifndef MATH_TABLES_H
+#define MATH_TABLES_H
+
+#include <stdint.h>
+
+#define SINE_TABLE_BITS {SINE_TABLE_BITS}
+
+#define ENEMY_PATH_X_PHASE_STEP {phase_step(ENEMY_PATH_X_FREQUENCY)}u
+#define ENEMY_PATH_Y_PHASE_STEP {phase_step(ENEMY_PATH_Y_FREQUENCY)}u
+
+#define ENEMY_MAX_SCALED_HITS {ENEMY_MAX_SCALED_HITS}
+
+/// sin over one full turn in Q2.14, so that 1 and -1 are exact
+static const int16_t sine_table[{sine_len + 1}] = {{
+{rows(sine, 8, str)}
+}};
+
+/// enemy shoot cooldown in ticks by hits taken
+static const uint8_t hits_to_shoot_cooldown_table[{ENEMY_MAX_SCALED_HITS + 1}] = {{
+{rows(cooldown, 16, str)}
+}};
+
+/// enemy pew speed in Q15.16 pixels per tick by hits taken
+static const int32_t hits_to_pew_speed_table[{ENEMY_MAX_SCALED_HITS + 1}] = {{
+{rows(speed, 8, str)}
+}};
+
+#endif""")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,188 @@
+#!/usr/bin/env python3
+"""
+Generates core/sprite_data.h, 1bpp bitmaps of the images/*.png icons for the
+software rasterizer in core/raster.c and the collision masks of core/sprite.c,
+along with the box around the set pixels of each and the outline drawn around
+them by fou_draw_outlined_icon.
+
+    python3 tools/gen_sprites.py > core/sprite_data.h
+
+Only depends on the standard library, the PNGs are decoded right here. Dark
+pixels are set, just like the firmware's icon converter does it.
+"""
+
+import os
+import struct
+import sys
+import zlib
+
+IMAGES_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "images")
+
+# Fou_Icon in core/flouhou.h and the image each one is drawn with
+ICONS = [
+    ("FOU_ICON_BADFILL", "BadFill_16x16.png"),
+    ("FOU_ICON_BADLAUGH0", "BadLaugh0_16x16.png"),
+    ("FOU_ICON_BADLAUGH1", "BadLaugh1_16x16.png"),
+    ("FOU_ICON_BAD0", "Bad0_16x16.png"),
+    ("FOU_ICON_BAD1", "Bad1_16x16.png"),
+    ("FOU_ICON_SHOT", "Shot_8x8.png"),
+    ("FOU_ICON_SPACESHIP", "SpaceShip_8x8.png"),
+    ("FOU_ICON_BADPEW", "BadPew_16x16.png"),
+    ("FOU_ICON_HEART", "Heart_8x8.png"),
+]
+
+# Icons outlined around the shape of another icon rather than their own, the
+# boss' faces have holes the outline must not show through
+OUTLINED_BY = {
+    "FOU_ICON_BADLAUGH0": "FOU_ICON_BADFILL",
+    "FOU_ICON_BADLAUGH1": "FOU_ICON_BADFILL",
+    "FOU_ICON_BAD0": "FOU_ICON_BADFILL",
+    "FOU_ICON_BAD1": "FOU_ICON_BADFILL",
+}
+
+MAX_SPRITE_WIDTH = 16
+
+
+def read_png(path):
+    """Decode a non-interlaced 8 bit PNG into rows of luminance values."""
+    with open(path, "rb") as f:
+        data = f.read()
+    if data[:8] != b"\x89PNG\r\n\x1a\n":
+        sys.exit(f"{path}: not a PNG")
+    pos = 8
+    idat = b""
+    palette = None
+    while pos < len(data):
+        (length,) = struct.unpack(">I", data[pos:pos + 4])
+        kind = data[pos + 4:pos + 8]
+        body = data[pos + 8:pos + 8 + length]
+        pos += 12 + length
+        if kind == b"IHDR":
+            width, height, depth, color_type, _, _, interlace = struct.unpack(">IIBBBBB", body)
+        elif kind == b"PLTE":
+            palette = [tuple(body[i:i + 3]) for i in range(0, len(body), 3)]
+        elif kind == b"IDAT":
+            idat += body
+    if depth != 8 or interlace != 0:
+        sys.exit(f"{path}: only non-interlaced 8 bit images are supported")
+    channels = {0: 1, 2: 3, 3: 1, 4: 2, 6: 4}[color_type]
+
+    raw = zlib.decompress(idat)
+    stride = width * channels
+    rows = []
+    prev = bytearray(stride)
+    for y in range(height):
+        start = y * (stride + 1)
+        filter_type = raw[start]
+        line = bytearray(raw[start + 1:start + 1 + stride])
+        for i in range(stride):
+            a = line[i - channels] if i >= channels else 0
+            b = prev[i]
+            c = prev[i - channels] if i >= channels else 0
+            if filter_type == 1:
+                line[i] = (line[i] + a) & 0xFF
+            elif filter_type == 2:
+                line[i] = (line[i] + b) & 0xFF
+            elif filter_type == 3:
+                line[i] = (line[i] + (a + b) // 2) & 0xFF
+            elif filter_type == 4:
+                p = a + b - c
+                pa, pb, pc = abs(p - a), abs(p - b), abs(p - c)
+                pred = a if pa <= pb and pa <= pc else (b if pb <= pc else c)
+                line[i] = (line[i] + pred) & 0xFF
+        prev = line
+
+        luminance = []
+        for x in range(width):
+            px = line[x * channels:(x + 1) * channels]
+            if color_type == 3:
+                r, g, b = palette[px[0]]
+            elif color_type in (0, 4):
+                r = g = b = px[0]
+            else:
+                r, g, b = px[0], px[1], px[2]
+            alpha = px[-1] if color_type in (4, 6) else 255
+            luminance.append(255 if alpha < 128 else (r * 299 + g * 587 + b * 114) // 1000)
+        rows.append(luminance)
+    return width, height, rows
+
+
+def opaque_box(rows):
+    """(x, y, w, h) of the smallest box around the set bits of `rows`."""
+    used = [y for y, row in enumerate(rows) if row != 0]
+    if not used:
+        return (0, 0, 0, 0)
+    columns = 0
+    for row in rows:
+        columns |= row
+    left = (columns & -columns).bit_length() - 1
+    right = columns.bit_length()
+    return (left, used[0], right - left, used[-1] + 1 - used[0])
+
+
+def outline_rows(rows, shape):
+    """Rows of the pixels the four copies of `shape` drawn one pixel to the left,
+    right, top and bottom cover outside of the set bits of `rows`. One pixel
+    bigger than the sprite on every side, bit x is column x - 1."""
+    padded = [0] + [row << 1 for row in shape] + [0]
+    body = [0] + [row << 1 for row in rows] + [0]
+    outline = []
+    for y in range(len(padded)):
+        above = padded[y - 1] if y > 0 else 0
+        below = padded[y + 1] if y + 1 < len(padded) else 0
+        covered = (padded[y] << 1) | (padded[y] >> 1) | above | below
+        outline.append(covered & ~body[y])
+    return outline
+
+
+def main():
+    bitmaps = {}
+    for enum_name, file_name in ICONS:
+        width, height, pixels = read_png(os.path.join(IMAGES_DIR, file_name))
+        if width > MAX_SPRITE_WIDTH:
+            sys.exit(f"{file_name}: sprites can be at most {MAX_SPRITE_WIDTH} pixels wide")
+        rows = [sum(1 << x for x in range(width) if row[x] < 128) for row in pixels]
+        bitmaps[enum_name] = (width, height, rows)
+
+    sprites = []
+    for enum_name, file_name in ICONS:
+        width, height, rows = bitmaps[enum_name]
+        outlined_by = OUTLINED_BY.get(enum_name, enum_name)
+        if bitmaps[outlined_by][:2] != (width, height):
+            sys.exit(f"{file_name}: outlined by {outlined_by}, which has another size")
+        outline = outline_rows(rows, bitmaps[outlined_by][2])
+        sprites.append(
+            (enum_name, file_name, width, height, rows, opaque_box(rows), outlined_by, outline))
+
+    print("""/*
+ * Generated by tools/gen_sprites.py, do not edit.
+ */
+
+#ifndef SPRITE_DATA_H
+#define SPRITE_DATA_H
+
+#include "sprite.h"
+""")
+    for enum_name, file_name, width, height, rows, _, _, outline in sprites:
+        name = enum_name.lower()
+        print(f"// {file_name}")
+        print(f"static const uint16_t {name}_rows[{height}] = {{")
+        for i in range(0, height, 8):
+            print("    " + " ".join(f"0x{r:04x}," for r in rows[i:i + 8]))
+        print("};")
+        print(f"static const uint32_t {name}_outline[{height + 2}] = {{")
+        for i in range(0, height + 2, 8):
+            print("    " + " ".join(f"0x{r:05x}," for r in outline[i:i + 8]))
+        print("};\n")
+    print("static const Fou_Sprite sprites[] = {")
+    for enum_name, _, width, height, _, (x, y, w, h), outlined_by, _ in sprites:
+        name = enum_name.lower()
+        opaque = f"{{{x}, {y}, {w}, {h}}}"
+        print(f"    [{enum_name}] = {{{width}, {height}, {name}_rows, {opaque},")
+        print(f"        {outlined_by}, {name}_outline}},")
+    print("};\n")
+    print("#endif")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,116 @@
+#!/usr/bin/env python3
+"""
+Summarizes a profiler trace written by core/profile.c.
+
+    python3 tools/profile_summary.py trace.foup
+    python3 tools/profile_summary.py --folded trace.foup > stacks.txt
+
+Prints count, min, average and max per phase plus a histogram of the power of
+two duration buckets. --folded prints the samples as folded stacks instead,
+"tick;pews 1234" with the self time in nanoseconds, which flamegraph.pl and
+speedscope read as they are.
+
+Only the last samples of every phase are in a trace, a sample counts as a
+child of a sample of its parent phase if it started and ended within it.
+"""
+
+import struct
+import sys
+
+MAGIC = b"FOUP"
+VERSION = 1
+NO_PARENT = 0xFF
+U32 = 2**32
+
+
+class Phase:
+    def __init__(self, name, parent, samples):
+        self.name = name
+        self.parent = parent
+        self.samples = samples  # (start, duration) in clock ticks
+
+
+def parse(data):
+    if data[:4] != MAGIC or data[4] != VERSION:
+        raise ValueError("not a version %d profiler trace" % VERSION)
+    clock_hz, phase_count = struct.unpack_from("<IB", data, 5)
+    pos = 10
+    phases = []
+    for _ in range(phase_count):
+        end = data.index(b"\0", pos)
+        name = data[pos:end].decode()
+        parent, count = struct.unpack_from("<BH", data, end + 1)
+        pos = end + 4
+        samples = [struct.unpack_from("<II", data, pos + 8 * i) for i in range(count)]
+        pos += 8 * count
+        phases.append(Phase(name, None if parent == NO_PARENT else parent, samples))
+    return clock_hz, phases
+
+
+def contains(outer, inner):
+    offset = (inner[0] - outer[0]) % U32
+    return offset + inner[1] <= outer[1]
+
+
+def stack(phases, index):
+    names = []
+    while index is not None:
+        names.append(phases[index].name)
+        index = phases[index].parent
+    return ";".join(reversed(names))
+
+
+def folded(clock_hz, phases):
+    self_time = {}
+    for index, phase in enumerate(phases):
+        children = [c for c in phases if c.parent == index]
+        for sample in phase.samples:
+            inside = sum(
+                child_sample[1]
+                for child in children
+                for child_sample in child.samples
+                if contains(sample, child_sample))
+            key = stack(phases, index)
+            self_time[key] = self_time.get(key, 0) + max(sample[1] - inside, 0)
+    for key, ticks in self_time.items():
+        print("%s %d" % (key, ticks * 10**9 // clock_hz))
+
+
+def summary(clock_hz, phases):
+    def us(ticks):
+        return ticks * 10**6 / clock_hz
+
+    print("%-12s %5s %9s %9s %9s  histogram (us, count)" % ("phase", "count", "min us",
+                                                            "avg us", "max us"))
+    for index, phase in enumerate(phases):
+        durations = [d for _, d in phase.samples]
+        name = "  " * stack(phases, index).count(";") + phase.name
+        if not durations:
+            print("%-12s %5d" % (name, 0))
+            continue
+        buckets = {}
+        for d in durations:
+            bucket = max(d.bit_length() - 1, 0)
+            buckets[bucket] = buckets.get(bucket, 0) + 1
+        histogram = " ".join("%.3g:%d" % (us(2**b), n) for b, n in sorted(buckets.items()))
+        print("%-12s %5d %9.2f %9.2f %9.2f  %s" % (name, len(durations), us(min(durations)),
+                                                   us(sum(durations) / len(durations)),
+                                                   us(max(durations)), histogram))
+
+
+def main():
+    args = sys.argv[1:]
+    as_folded = "--folded" in args
+    args = [a for a in args if a != "--folded"]
+    if len(args) != 1:
+        sys.exit(__doc__.strip())
+    with open(args[0], "rb") as f:
+        clock_hz, phases = parse(f.read())
+    if as_folded:
+        folded(clock_hz, phases)
+    else:
+        summary(clock_hz, phases)
+
+
+if __name__ == "__main__":
+    main()